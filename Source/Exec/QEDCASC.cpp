@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <string>
 
 #include "EMField.hh"
@@ -5,24 +7,29 @@
 #include "StaticEMField.hh"
 #include "PlaneEMField.hh"
 #include "FocusingField.hh"
+#include "CachedEMField.hh"
+#include "CompositeEMField.hh"
+#include "GriddedEMField.hh"
 
 #include "ParticlePusher.hh"
-#include "LorentzPusher.hh"
-#include "LandauPusher.hh"
-#include "ModifiedLandauPusher.hh"
+#include "AdaptiveStepper.hh"
+#include "StepTasks.hh"
 
 #include "ParticleList.hh"
 #include "SourceGenerator.hh"
+#include "ParticleArena.hh"
 
 #include "ContinuousEmission.hh"
 #include "StochasticEmission.hh"
 #include "NonLinearBreitWheeler.hh"
+#include "PhotonDecay.hh"
 
 #include "FileParser.hh"
 #include "Histogram.hh"
 #include "OutputManager.hh"
 
 #include "MCTools.hh"
+#include "TaskScheduler.hh"
 
 #ifdef USEOPENMP
     #include <omp.h>
@@ -31,6 +38,49 @@
     #include <mpi.h>
 #endif
 
+// Builds the field of one field section, nullptr if its type is unknown
+EMField* CreateField(const FieldParameters& inField)
+{
+    EMField* field;
+    if (inField.Type == "static")
+    {
+        field = new StaticEMField(inField.E, inField.B);
+    } else if (inField.Type == "plane")
+    {
+        field = new PlaneEMField(inField.MaxE, inField.Wavelength,
+            inField.Polerisation, inField.Direction);
+    } else if (inField.Type == "gaussian")
+    {
+        field = new GaussianEMField(inField.MaxE, inField.Wavelength,
+            inField.Duration, inField.Waist, inField.Polerisation,
+            inField.Start, inField.Focus);
+    } else if (inField.Type == "focusing")
+    {
+        field = new FocusingField(inField.MaxE, inField.Wavelength,
+            inField.Duration, inField.Waist, inField.Polerisation,
+            inField.Start, inField.Focus);
+    } else if (inField.Type == "grid")
+    {
+        field = new GriddedEMField(inField.GridFile, inField.GridLength,
+            inField.GridTime, inField.GridE, inField.GridB, inField.GridSlices);
+    } else
+    {
+        std::cerr << "Error: unknown field type." << std::endl;
+        return nullptr;
+    }
+
+    // Interpolate the field from a cached grid if one is requested
+    if (inField.CacheSpacing > 0)
+    {
+        FieldInterpolation interpolation = inField.CacheInterpolation == "cubic"
+            ? FieldInterpolation::Cubic : FieldInterpolation::Linear;
+        field = new CachedEMField(field, inField.CacheSpacing,
+            inField.CacheTimeStep, inField.CacheBrick, inField.CacheMemory,
+            interpolation);
+    }
+    return field;
+}
+
 int main(int argc, char* argv[])
 {
     if (argc == 1)
@@ -67,69 +117,67 @@ int main(int argc, char* argv[])
     }
 
     // set up MPI if we are using it 
+    int id(0);
 #ifdef USEMPI
     MPI_Init(&argc, &argv);
-    // Set random seed with MPI rank
-    int id;
     MPI_Comm_rank(MPI_COMM_WORLD, &id);
-    MCTools::SetSeed(id);
 #endif
     // Parse the file
     FileParser* input = new FileParser(argv[1], true);
     // Get the input paramter structs
     GeneralParameters inGeneral = input->GetGeneral();
-    FieldParameters inField = input->GetField();
+    std::vector<FieldParameters> inFields = input->GetFields();
     PhysicsParameters inPhysics = input->GetPhysics();
     std::vector<ParticleParameters> inParticles = input->GetParticle();
     std::vector<HistogramParameters> inHistogram = input->GetHistograms();
     delete input;
 
+    // Set random seed with MPI rank
+    MCTools::SetSeed(inGeneral.seed, id);
 
-    // Set up the fields
+
+    // Set up the fields, several field sections are summed
     EMField* field;
-    if (inField.Type == "static")
+    if (inFields.empty())
     {
-        field = new StaticEMField(inField.E, inField.B);
-    } else if (inField.Type == "plane")
-    {
-        field = new PlaneEMField(inField.MaxE, inField.Wavelength,
-            inField.Polerisation, inField.Direction);
-    } else if (inField.Type == "gaussian")
-    {
-        field = new GaussianEMField(inField.MaxE, inField.Wavelength,
-            inField.Duration, inField.Waist, inField.Polerisation,
-            inField.Start, inField.Focus);
-    } else if (inField.Type == "focusing")
+        std::cerr << "Error: no field section provided." << std::endl;
+        return 1;
+    } else if (inFields.size() == 1)
     {
-        field = new FocusingField(inField.MaxE, inField.Wavelength,
-            inField.Duration, inField.Waist, inField.Polerisation,
-            inField.Start, inField.Focus);
+        field = CreateField(inFields[0]);
+        if (field == nullptr) return 1;
     } else
     {
-        std::cerr << "Error: unknown field type." << std::endl;
-        return 1;
+        CompositeEMField* composite = new CompositeEMField();
+        for (unsigned int i = 0; i < inFields.size(); i++)
+        {
+            EMField* component = CreateField(inFields[i]);
+            if (component == nullptr) return 1;
+            composite->AddField(component);
+        }
+        field = composite;
     }
 
     // Set the physics
-    ParticlePusher* pusher;
+    RadiationReaction radReaction;
     std::vector<Process*> processList;
     if (inPhysics.Physics == "Classical" || inPhysics.Physics == "classical")
     {
-        pusher = new LandauPusher(field, inGeneral.timeStep);
+        radReaction = RadiationReaction::Landau;
         ContinuousEmission* emission = new ContinuousEmission(field,
             inGeneral.timeStep, true, inPhysics.SampleFraction,
             inPhysics.MinEnergy, inGeneral.tracking);
         processList.push_back(emission);
     } else if (inPhysics.Physics == "Semiclassical" || inPhysics.Physics == "semiclassical")
     {
-        pusher = new ModifiedLandauPusher(field, inGeneral.timeStep);
+        radReaction = RadiationReaction::ModifiedLandau;
         ContinuousEmission* emission = new ContinuousEmission(field,
             inGeneral.timeStep, false, inPhysics.SampleFraction,
             inPhysics.MinEnergy, inGeneral.tracking);
         processList.push_back(emission);
     } else if (inPhysics.Physics == "Quantum" || inPhysics.Physics == "quantum")
     {
-        pusher = new LorentzPusher(field, inGeneral.timeStep);
+        radReaction = RadiationReaction::None;
         StochasticEmission* emission = new StochasticEmission(field,
             inGeneral.timeStep, inPhysics.SampleFraction, inPhysics.MinEnergy,
             inGeneral.tracking);
@@ -141,11 +189,47 @@ int main(int argc, char* argv[])
         return 1; 
     }
 
+    ParticlePusher* pusher = ParticlePusher::Create(inPhysics.Pusher, field,
+        inGeneral.timeStep, radReaction);
+    if (pusher == nullptr && (inPhysics.Pusher == "Exact"
+        || inPhysics.Pusher == "exact"))
+    {
+        std::cerr << "Error: The exact pusher needs Quantum physics and a "
+                     "single static or plane field" << std::endl;
+        return 1;
+    } else if (pusher == nullptr)
+    {
+        std::cerr << "Error: Unknown pusher \"" << inPhysics.Pusher
+                  << "\"" << std::endl;
+        return 1;
+    }
+
+    // Photons go straight, so rather than stepping pair production each
+    // photon's decay is found once along its path
+    NonLinearBreitWheeler* breitWheeler = nullptr;
     if (inPhysics.PairProduction == true)
     {
-        NonLinearBreitWheeler* breitWheeler = new NonLinearBreitWheeler(field, 
-            inGeneral.timeStep, false);
-        processList.push_back(breitWheeler);
+        breitWheeler = new NonLinearBreitWheeler(field, inGeneral.timeStep,
+            false);
+    }
+
+    // Cascade sizes differ by orders of magnitude, so the events are
+    // balanced over the threads by stealing rather than split up front, and
+    // the steps of the largest are split between the threads too
+#ifdef USEOPENMP
+    TaskScheduler scheduler(omp_get_max_threads());
+#else
+    TaskScheduler scheduler;
+#endif
+    StepTasks stepTasks(&scheduler, inGeneral.splitParticles);
+
+    // Leptons may take their own time steps within each step of the pusher
+    AdaptiveStepper* stepper = nullptr;
+    if (inGeneral.adaptiveStep == true)
+    {
+        stepper = new AdaptiveStepper(pusher, processList,
+            inGeneral.minTimeStep, inGeneral.gyroFraction,
+            inGeneral.maxOpticalDepth, &stepTasks);
     }
 
     // set up the particle sources
@@ -157,7 +241,7 @@ int main(int argc, char* argv[])
                 inParticles[i].Energy1, inParticles[i].Energy2,
                 inParticles[i].Radius, inParticles[i].Duration,
                 inParticles[i].Divergence, inParticles[i].Position, 
-                inParticles[i].Direction, inGeneral.tracking);
+                inParticles[i].Direction, inGeneral.tracking, i);
         generators[i] = source;
     }
 
@@ -172,6 +256,14 @@ int main(int argc, char* argv[])
 
     // Set up output manager
     OutputManager* out = new OutputManager(inGeneral.fileName);
+
+    // Every thread fills its own copy of the histograms and track store,
+    // which are merged in a fixed order after each source
+    out->SetThreads(scheduler.GetNThreads());
+    for (unsigned int i = 0; i < histograms.size(); i++)
+    {
+        histograms[i]->SetThreads(scheduler.GetNThreads());
+    }
     // Set up is complete, print info
     unsigned int nEvents(0);
     for (unsigned int i = 0; i < inParticles.size(); i++)
@@ -192,22 +284,28 @@ int main(int argc, char* argv[])
         // set up the full event store
         if (inParticles[i].Output == true) out->InitSource(generators[i]->GetSourceNumber());
 
-#ifdef USEOPENMP
-        int threadEvents = generators[i]->GetSourceNumber();
-        #pragma omp parallel for
-#endif
-        for (unsigned int j = 0; j < generators[i]->GetSourceNumber(); j++) // loop events
+        unsigned long threadEvents = generators[i]->GetSourceNumber();
+        scheduler.Run(threadEvents, [&](unsigned long j) // loop events
         {
+            // Each event draws from its own random stream
+            MCTools::SetEventStream(j, i);
+
             // Generate source
-            ParticleList* event = generators[i]->GenerateList();
+            ParticleList* event = generators[i]->GenerateList(j);
 
             // Store full event info
             if (inParticles[i].Output == true) out->StoreSource(event, j, true);
 
+            PhotonDecay* decay = breitWheeler != nullptr
+                ? new PhotonDecay(breitWheeler, inGeneral.timeEnd) : nullptr;
+
             unsigned int histCount(0);
             double time(0);
             while(time < inGeneral.timeEnd) // loop time
             {
+                // Decay the photons due by now
+                if (decay != nullptr) decay->Update(event, time);
+
                 // Check if time for histogram
                 if (histCount < histograms.size())
                 {
@@ -217,34 +315,71 @@ int main(int argc, char* argv[])
                         for (unsigned int k = 0; k < event->GetNPart(); k++)
                         {
                             if (histograms[histCount]->GetParticle() == 
-                                event->GetParticle(k)->GetName())
+                                event->GetSpeciesName(k))
                             {
-                                histograms[histCount]->AppParticle(event->GetParticle(k));
+                                histograms[histCount]->AppParticle(event, k);
                             }
                         }
                         histCount++;
                     }
                 }
-                // Push particles and interact
-                for (unsigned int k = 0; k < event->GetNPart(); k++) // Loop particles
+                // Away from the field the particles go straight, so they jump
+                // to where they can next meet it, stopping at the next
+                // histogram or the end
+                double stopTime = inGeneral.timeEnd;
+                if (histCount < histograms.size())
+                {
+                    stopTime = std::min(stopTime, histograms[histCount]->GetTime());
+                }
+                double maxSteps = (stopTime - time) / inGeneral.timeStep;
+                maxSteps = stepper != nullptr ? std::floor(maxSteps)
+                    : std::ceil(maxSteps);
+                unsigned int steps = pusher->FreeStream(event,
+                    maxSteps > 0 ? maxSteps : 0);
+                if (steps == 0 && stepper != nullptr)
                 {
-                    pusher->PushParticle(event->GetParticle(k));
-                    for (unsigned int proc = 0; proc < processList.size(); proc++) // loop processes
+                    // The last step is shortened to end exactly at the next
+                    // histogram or the end
+                    double step = std::min(inGeneral.timeStep, stopTime - time);
+                    if (step > 0) stepper->Step(event, step);
+                    time = step < inGeneral.timeStep ? stopTime : time + step;
+                    continue;
+                } else if (steps == 0)
+                {
+                    // Push particles and interact, a range at a time if the
+                    // event is split. Secondaries already have the time at
+                    // the end of the step so wait for the next one
+                    event->AdvancePhotons(pusher->GetTimeStep());
+                    stepTasks.ForEachRange(event,
+                        [&](unsigned int begin, unsigned int end)
                     {
-                        processList[proc]->Interact(event->GetParticle(k), event);
-                    }
+                        pusher->PushParticleRange(event, begin, end);
+                        for (unsigned int k = begin; k < end; k++) // Loop particles
+                        {
+                            // The processes stepped only act on leptons
+                            if (event->IsBallistic(k)) continue;
+                            for (unsigned int proc = 0; proc < processList.size(); proc++) // loop processes
+                            {
+                                processList[proc]->Interact(event, k);
+                            }
+                        }
+                    });
+                    steps = 1;
                 }
-                time += inGeneral.timeStep;
+                for (unsigned int k = 0; k < steps; k++) time += inGeneral.timeStep;
             }
+            if (decay != nullptr) decay->Update(event, time);
+            delete decay;
+
             // fill any non filled histograms
             for (unsigned int k = histCount; k < histograms.size(); k++)
             {
                 for (unsigned int l = 0; l < event->GetNPart(); l++)
                 {
                     if (histograms[k]->GetParticle() == 
-                        event->GetParticle(l)->GetName())
+                        event->GetSpeciesName(l))
                     {
-                        histograms[k]->AppParticle(event->GetParticle(l));
+                        histograms[k]->AppParticle(event, l);
                     }
                 }
             }
@@ -258,14 +393,19 @@ int main(int argc, char* argv[])
             
             // Approx % complete timer
 #ifdef USEOPENMP
-
-            if (omp_get_thread_num() == 0 && j % 5 == 0)
+            unsigned long completed = scheduler.GetCompleted();
+            if (TaskScheduler::ThreadIndex() == 0 && completed % 5 == 0)
             {
                 std::cout << "Approximately " << 
-                (double) (j* omp_get_max_threads()) / threadEvents * 100.0 
+                (double) completed / threadEvents * 100.0 
                 << "% complete \r";
             }
 #endif
+        });
+        out->MergeShards();
+        for (unsigned int k = 0; k < histograms.size(); k++)
+        {
+            histograms[k]->MergeShards();
         }
 #ifdef USEMPI
         out->OutputEventsMPI(inParticles[i].Output, inGeneral.tracking);
@@ -277,10 +417,16 @@ int main(int argc, char* argv[])
 #ifdef USEOPENMP
     std::cout << "Simulation complete in time: "; 
     std::cout << omp_get_wtime() - startTime << " s" << std::endl;
+    std::cout << "Particle chunks allocated: " << ParticleArena::GetAllocations();
+    std::cout << ", reused: " << ParticleArena::GetReuses() << std::endl;
     std::cout << "Saving data to file: " << inGeneral.fileName;
     std::cout << " and cleaning up...\n";
 #endif
 
+    field->PrintStats(std::cout);
+    if (stepper != nullptr) stepper->PrintStats(std::cout);
+    scheduler.PrintStats(std::cout);
+
     for (unsigned int i = 0; i < inHistogram.size(); i++)
     {
 #ifdef USEMPI
@@ -292,6 +438,8 @@ int main(int argc, char* argv[])
     }
 
     delete field;
+    delete breitWheeler;
+    delete stepper;
     delete pusher;
     delete out;
 
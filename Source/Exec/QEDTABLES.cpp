@@ -0,0 +1,40 @@
+#include <iostream>
+#include <string>
+
+#include "TableFile.hh"
+#include "QEDTables.hh"
+
+// Converts the text QED tables to the binary format, this only needs to be
+// done once per tables directory
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: QEDTABLES <tables directory> [output file]\n";
+        std::cerr << "The output defaults to <tables directory>/"
+                  << QEDTables::binaryName << "\n";
+        return 1;
+    }
+
+    std::string path(argv[1]);
+    std::string fileName = argc == 3 ? std::string(argv[2])
+        : path + "/" + QEDTables::binaryName;
+
+    TableFile tables;
+    QEDTables::ReadText(path, tables);
+    if (!tables.Write(fileName))
+    {
+        std::cerr << "Error: Failed to write " << fileName << std::endl;
+        return 1;
+    }
+
+    // Check the file reads back before anyone relies on it
+    TableFile check;
+    if (!check.Open(fileName))
+    {
+        std::cerr << "Error: Failed to read back " << fileName << std::endl;
+        return 1;
+    }
+    std::cout << "Tables written to " << fileName << std::endl;
+    return 0;
+}
@@ -15,6 +15,7 @@
 #include "StochasticEmission.hh"
 #include "NonLinearBreitWheeler.hh"
 #include "FileParser.hh"
+#include "MCTools.hh"
 
 
 G4CascadeGenerator::G4CascadeGenerator(std::string iniPath,
@@ -119,18 +120,21 @@ void G4CascadeGenerator::SimulateEvent()
     {
         m_source->FreeSources(m_event);
     }
-    m_event = m_source->GenerateList();
+    MCTools::SetEventStream(m_currentEvent);
+    m_event = m_source->GenerateList(m_currentEvent);
     double time = 0;
 
     while(time < m_timeEnd) // loop time
     {
-        // Push particles and interact
-        for (unsigned int i = 0; i < m_event->GetNPart(); i++) // Loop particles
+        // Push particles and interact. Secondaries already have the time
+        // at the end of the step so wait for the next one
+        unsigned int nPart = m_event->GetNPart();
+        m_pusher->PushParticleList(m_event);
+        for (unsigned int i = 0; i < nPart; i++) // Loop particles
         {
-            m_pusher->PushParticle(m_event->GetParticle(i));
             for (unsigned int proc = 0; proc < m_processList.size(); proc++) // loop processes
             {
-                m_processList[proc]->Interact(m_event->GetParticle(i), m_event);
+                m_processList[proc]->Interact(m_event, i);
             }
         }
         time += m_timeStep;  
@@ -155,10 +159,10 @@ void G4CascadeGenerator::GeneratePrimaries(G4Event* anEvent)
             SimulateEvent();
         }
         // Load the gun params
-        if(m_event->GetParticle(m_currentSecondary)->GetName() == "Electron")
+        if(m_event->GetSpeciesName(m_currentSecondary) == "Electron")
         {  
             m_particleGun->SetParticleDefinition(m_electronDef);
-        } else if (m_event->GetParticle(m_currentSecondary)->GetName()
+        } else if (m_event->GetSpeciesName(m_currentSecondary)
             == "Positron")
         {
             m_particleGun->SetParticleDefinition(m_positronDef);
@@ -168,11 +172,10 @@ void G4CascadeGenerator::GeneratePrimaries(G4Event* anEvent)
         }
 
          m_particleGun->SetParticleEnergy(
-            m_event->GetParticle(m_currentSecondary)->GetEnergy()
+            m_event->GetEnergy(m_currentSecondary)
                                 / m_units->G4Energy());
 
-         ThreeVector dir = m_event->GetParticle(m_currentSecondary)
-            ->GetDirection();
+         ThreeVector dir = m_event->GetDirection(m_currentSecondary);
 
         m_particleGun->SetParticleMomentumDirection(
             G4ThreeVector(dir[0], dir[1], dir[2]));
@@ -9,7 +9,7 @@
 
 G4StochasticEmission::G4StochasticEmission(double dt, double tEnd,
                                        const G4String& name, G4ProcessType type):
-G4VDiscreteProcess(name, type), m_process(NULL), m_pusher(NULL)
+G4VDiscreteProcess(name, type), m_event(NULL), m_process(NULL), m_pusher(NULL)
 {
     m_units = new UnitsSystem("SI");
     m_dt = dt / m_units->RefTime();
@@ -20,7 +20,7 @@ G4VDiscreteProcess(name, type), m_process(NULL), m_pusher(NULL)
 G4StochasticEmission::~G4StochasticEmission()
 {
     delete m_field;
-    delete m_part;
+    delete m_event;
     delete m_g4_part;
     delete m_process;
     delete m_pusher;
@@ -41,38 +41,44 @@ G4VParticleChange* G4StochasticEmission::PostStepDoIt(const G4Track& aTrack, con
                                        g4_position[1],
                                        g4_position[2]);
 
-    m_part = new Lepton(mass, charge, energy, position, direction);
-    m_photonList = new ParticleList("Photons");
+    // The list is kept between steps so its memory is reused
+    if (m_event == NULL)
+    {
+        m_event = new ParticleList("Photons");
+    } else
+    {
+        m_event->Clear();
+    }
+    m_event->AddParticle(charge == -1 ? Species::Electron : Species::Positron,
+        position, energy * direction.Norm());
 
     double time(0);
     while(time < m_tEnd)
     {
-        m_pusher->PushParticle(m_part);
-        m_pusher->PushParticleList(m_photonList);
-        m_process->Interact(m_part, m_photonList);
+        m_pusher->PushParticleList(m_event);
+        m_process->Interact(m_event, 0);
         time += m_dt;
     }
 
     aParticleChange.Initialize(aTrack);
-    aParticleChange.SetNumberOfSecondaries(m_photonList->GetNPart());
-    for (unsigned int i = 0; i < m_photonList->GetNPart(); i++)
+    aParticleChange.SetNumberOfSecondaries(m_event->GetNPart() - 1);
+    for (unsigned int i = 1; i < m_event->GetNPart(); i++)
     {
-        Particle* gamma = m_photonList->GetParticle(i);
-        G4double gammaEnergy = gamma->GetEnergy() / m_units->G4Energy();
-        G4ThreeVector gammaDirection = G4ThreeVector(gamma->GetDirection()[0],
-                                                     gamma->GetDirection()[1],
-                                                     gamma->GetDirection()[2]);
+        G4double gammaEnergy = m_event->GetEnergy(i) / m_units->G4Energy();
+        ThreeVector gammaDir = m_event->GetDirection(i);
+        G4ThreeVector gammaDirection = G4ThreeVector(gammaDir[0],
+                                                     gammaDir[1],
+                                                     gammaDir[2]);
         m_g4_part = new G4DynamicParticle(G4Gamma::Gamma(), gammaDirection, gammaEnergy);
         aParticleChange.AddSecondary(m_g4_part);
     }
-    G4ThreeVector partDirection = G4ThreeVector(m_part->GetDirection()[0],
-                                                m_part->GetDirection()[1],
-                                                m_part->GetDirection()[2]);
+    ThreeVector partDir = m_event->GetDirection(0);
+    G4ThreeVector partDirection = G4ThreeVector(partDir[0],
+                                                partDir[1],
+                                                partDir[2]);
     aParticleChange.ProposeMomentumDirection(partDirection);
-    aParticleChange.ProposeEnergy(m_part->GetEnergy() / m_units->G4Energy());
+    aParticleChange.ProposeEnergy(m_event->GetEnergy(0) / m_units->G4Energy());
 
-    delete m_part;
-    delete m_photonList;
     return G4VDiscreteProcess::PostStepDoIt(aTrack, aStep);
 }
 
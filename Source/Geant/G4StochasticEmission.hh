@@ -6,7 +6,6 @@
 #include "G4Step.hh"
 #include "G4VParticleChange.hh"
 
-#include "Particle.hh"
 #include "ParticleList.hh"
 #include "LorentzPusher.hh"
 #include "StochasticEmission.hh"
@@ -43,8 +42,7 @@ private:
     bool m_pSwitch = false;         // switch determining if process occured
 
     UnitsSystem* m_units;           // QED units system
-    Particle* m_part;               // qed particle 
-    ParticleList* m_photonList;     // list of secondaries
+    ParticleList* m_event;          // qed particle (index 0) and secondaries
     EMField* m_field;               // field which particles are pushed through
     StochasticEmission* m_process;  // Stochastic emission
     LorentzPusher* m_pusher;        // particle poshuer
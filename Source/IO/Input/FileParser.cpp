@@ -68,6 +68,14 @@ void FileParser::ReadGeneral()
     m_general.timeEnd = m_reader->GetReal("General", "time_end", 0) / m_units->RefTime();
     m_general.fileName = m_reader->GetString("General", "file_name", "out.h5");
     m_general.tracking = m_reader->GetBoolean("General", "tracking", false);
+    m_general.seed = m_reader->GetInteger("General", "seed", 0);
+    m_general.adaptiveStep = m_reader->GetBoolean("General", "adaptive_step", false);
+    m_general.minTimeStep = m_reader->GetReal("General", "min_time_step", 0)
+        / m_units->RefTime();
+    if (m_general.minTimeStep <= 0) m_general.minTimeStep = m_general.timeStep / 64.0;
+    m_general.gyroFraction = m_reader->GetReal("General", "gyro_fraction", 0.05);
+    m_general.maxOpticalDepth = m_reader->GetReal("General", "max_optical_depth", 0.1);
+    m_general.splitParticles = m_reader->GetInteger("General", "split_particles", 8192);
 
     if (m_checkOutput == true)
     {
@@ -77,112 +85,185 @@ void FileParser::ReadGeneral()
         m_checkFile << "Time end    = " << m_general.timeEnd << "\n";
         m_checkFile << "Output file = " << m_general.fileName << "\n";
         m_checkFile << "Tracking    = " << m_general.tracking << "\n";
+        m_checkFile << "Seed        = " << m_general.seed << "\n";
+        m_checkFile << "Split parts = " << m_general.splitParticles << "\n";
+        if (m_general.adaptiveStep == true)
+        {
+            m_checkFile << "Min step    = " << m_general.minTimeStep << "\n";
+            m_checkFile << "Gyro frac   = " << m_general.gyroFraction << "\n";
+            m_checkFile << "Max depth   = " << m_general.maxOpticalDepth << "\n";
+        }
         m_checkFile << "\n\n";
     }
 }
 
 void FileParser::ReadField()
 {
+    // A [Field] section and any number of [Field1], [Field2], ... sections,
+    // the fields of all of them are summed
     if (std::find(m_sections.begin(), m_sections.end(), "Field") != m_sections.end())
     {
-        m_field.Type = m_reader->GetString("Field", "field_type", "");
-        if (m_field.Type != "gaussian" && m_field.Type != "plane"
-            && m_field.Type != "static" && m_field.Type != "focusing")
-         {
-            std::cerr << "Input error: Field type \"" << m_field.Type << "\" is not recognise.\n";
-            std::cerr << "Exiting!\n";
-            exit(1);
-         } 
-         if (m_field.Type == "static")
-         {
-            m_field.E = m_reader->GetThreeVector("Field", "e_field", ThreeVector(0,0,0)) 
-                                                                       / m_units->RefEField();
-            m_field.B = m_reader->GetThreeVector("Field", "b_field", ThreeVector(0,0,0))
-                                                                      / m_units->RefBField();
-            if (m_checkOutput == true)
-            {
-                m_checkFile << "Field input parameters \n";
-                m_checkFile << "Field type = " << m_field.Type << "\n";
-                m_checkFile << "E strength = [" << m_field.E[0] << " " << m_field.E[1]
-                            << " " << m_field.E[2] << "]\n";
-                m_checkFile << "B strength = [" << m_field.B[0] << " " << m_field.B[1]
-                            << " " << m_field.B[2] << "]\n";
-                m_checkFile << "\n\n";
-            }
-         } else if (m_field.Type == "plane")
-         {
-            m_field.MaxE = m_reader->GetReal("Field", "e_max", 0) / m_units->RefEField();
-            m_field.Wavelength = m_reader->GetReal("Field", "wavelength", 1) / m_units->RefLength();
-            m_field.Direction = m_reader->GetThreeVector("Field", "direction", ThreeVector(0,0,1));
-            m_field.Polerisation = m_reader->GetReal("Field", "polerisation", 0);
-            if (m_checkOutput == true)
-            {
-                m_checkFile << "Field input parameters \n";
-                m_checkFile << "Field type  = " << m_field.Type << "\n";
-                m_checkFile << "Wavelength  = " << m_field.Wavelength << "\n";
-                m_checkFile << "Direction   = [" << m_field.Direction[0] << " "
-                            << m_field.Direction[1] << " " << m_field.Direction[2] << "]\n";
-                m_checkFile << "Polerisation = " << m_field.Polerisation << "\n";
-                m_checkFile << "\n\n";
-            }
-         } else if (m_field.Type == "gaussian")
-         {
-            m_field.MaxE = m_reader->GetReal("Field", "e_max", 0) / m_units->RefEField();
-            m_field.Wavelength = m_reader->GetReal("Field", "wavelength", 1) / m_units->RefLength();
-            m_field.Duration = m_reader->GetReal("Field", "duration", 1) / m_units->RefTime();
-            m_field.Waist = m_reader->GetReal("Field", "waist", 1) / m_units->RefLength();
-            m_field.Polerisation = m_reader->GetReal("Field", "polerisation", 0);
-            m_field.Start = m_reader->GetThreeVector("Field", "start", ThreeVector(0,0,0)) 
-                                                                    / m_units->RefLength();
-            m_field.Focus = m_reader->GetThreeVector("Field", "focus", ThreeVector(0,0,0))
-                                                                    / m_units->RefLength();
-            if (m_checkOutput == true)
-            {
-                m_checkFile << "Field input parameters \n";
-                m_checkFile << "Field type  = "   << m_field.Type << "\n";
-                m_checkFile << "Max E       = "   << m_field.MaxE << "\n";
-                m_checkFile << "Duration    = "   << m_field.Duration << "\n";
-                m_checkFile << "Waist       = "   << m_field.Waist << "\n";             
-                m_checkFile << "Wavelength  = "   << m_field.Wavelength << "\n";
-                m_checkFile << "Start       = ["  << m_field.Start[0] << " "
-                            << m_field.Start[1]   << " " << m_field.Start[2] << "]\n";
-                m_checkFile << "Focus       = ["  << m_field.Focus[0] << " "
-                            << m_field.Focus[1]   << " " << m_field.Focus[2] << "]\n";
-                m_checkFile << "\n\n";
-            }                                                                   
-         } else if (m_field.Type == "focusing")
-         {
-            m_field.MaxE = m_reader->GetReal("Field", "e_max", 0) / m_units->RefEField();
-            m_field.Wavelength = m_reader->GetReal("Field", "wavelength", 1) / m_units->RefLength();
-            m_field.Duration = m_reader->GetReal("Field", "duration", 1) / m_units->RefTime();
-            m_field.Waist = m_reader->GetReal("Field", "waist", 1) / m_units->RefLength();
-            m_field.Polerisation = m_reader->GetReal("Field", "polerisation", 0);
-            m_field.Start = m_reader->GetThreeVector("Field", "start", ThreeVector(0,0,0)) 
-                                                                    / m_units->RefLength();
-            m_field.Focus = m_reader->GetThreeVector("Field", "focus", ThreeVector(0,0,0))
-                                                                    / m_units->RefLength();
-            if (m_checkOutput == true)
-            {
-                m_checkFile << "Field input parameters \n";
-                m_checkFile << "Field type  = "   << m_field.Type << "\n";
-                m_checkFile << "Max E       = "   << m_field.MaxE << "\n";
-                m_checkFile << "Duration    = "   << m_field.Duration << "\n";
-                m_checkFile << "Waist       = "   << m_field.Waist << "\n";             
-                m_checkFile << "Wavelength  = "   << m_field.Wavelength << "\n";
-                m_checkFile << "Start       = ["  << m_field.Start[0] << " "
-                            << m_field.Start[1]   << " " << m_field.Start[2] << "]\n";
-                m_checkFile << "Focus       = ["  << m_field.Focus[0] << " "
-                            << m_field.Focus[1]   << " " << m_field.Focus[2] << "]\n";
-                m_checkFile << "\n\n";
-            }                                                                   
-         }
+        m_fields.push_back(ReadFieldSection("Field"));
+    }
+    unsigned int i(1);
+    while (std::find(m_sections.begin(), m_sections.end(), "Field" + std::to_string(i))
+           != m_sections.end())
+    {
+        m_fields.push_back(ReadFieldSection("Field" + std::to_string(i)));
+        i++;
     }
 }
 
+FieldParameters FileParser::ReadFieldSection(const std::string& section)
+{
+    FieldParameters field;
+    field.Type = m_reader->GetString(section, "field_type", "");
+    if (field.Type != "gaussian" && field.Type != "plane"
+        && field.Type != "static" && field.Type != "focusing"
+        && field.Type != "grid")
+    {
+        std::cerr << "Input error: Field type \"" << field.Type << "\" is not recognise.\n";
+        std::cerr << "Exiting!\n";
+        exit(1);
+    }
+    if (field.Type == "static")
+    {
+        field.E = m_reader->GetThreeVector(section, "e_field", ThreeVector(0,0,0)) 
+                                                                   / m_units->RefEField();
+        field.B = m_reader->GetThreeVector(section, "b_field", ThreeVector(0,0,0))
+                                                                  / m_units->RefBField();
+        if (m_checkOutput == true)
+        {
+            m_checkFile << "Field input parameters \n";
+            m_checkFile << "Field type = " << field.Type << "\n";
+            m_checkFile << "E strength = [" << field.E[0] << " " << field.E[1]
+                        << " " << field.E[2] << "]\n";
+            m_checkFile << "B strength = [" << field.B[0] << " " << field.B[1]
+                        << " " << field.B[2] << "]\n";
+            m_checkFile << "\n\n";
+        }
+    } else if (field.Type == "plane")
+    {
+        field.MaxE = m_reader->GetReal(section, "e_max", 0) / m_units->RefEField();
+        field.Wavelength = m_reader->GetReal(section, "wavelength", 1) / m_units->RefLength();
+        field.Direction = m_reader->GetThreeVector(section, "direction", ThreeVector(0,0,1));
+        field.Polerisation = m_reader->GetReal(section, "polerisation", 0);
+        if (m_checkOutput == true)
+        {
+            m_checkFile << "Field input parameters \n";
+            m_checkFile << "Field type  = " << field.Type << "\n";
+            m_checkFile << "Wavelength  = " << field.Wavelength << "\n";
+            m_checkFile << "Direction   = [" << field.Direction[0] << " "
+                        << field.Direction[1] << " " << field.Direction[2] << "]\n";
+            m_checkFile << "Polerisation = " << field.Polerisation << "\n";
+            m_checkFile << "\n\n";
+        }
+    } else if (field.Type == "gaussian")
+    {
+        field.MaxE = m_reader->GetReal(section, "e_max", 0) / m_units->RefEField();
+        field.Wavelength = m_reader->GetReal(section, "wavelength", 1) / m_units->RefLength();
+        field.Duration = m_reader->GetReal(section, "duration", 1) / m_units->RefTime();
+        field.Waist = m_reader->GetReal(section, "waist", 1) / m_units->RefLength();
+        field.Polerisation = m_reader->GetReal(section, "polerisation", 0);
+        field.Start = m_reader->GetThreeVector(section, "start", ThreeVector(0,0,0)) 
+                                                                / m_units->RefLength();
+        field.Focus = m_reader->GetThreeVector(section, "focus", ThreeVector(0,0,0))
+                                                                / m_units->RefLength();
+        if (m_checkOutput == true)
+        {
+            m_checkFile << "Field input parameters \n";
+            m_checkFile << "Field type  = "   << field.Type << "\n";
+            m_checkFile << "Max E       = "   << field.MaxE << "\n";
+            m_checkFile << "Duration    = "   << field.Duration << "\n";
+            m_checkFile << "Waist       = "   << field.Waist << "\n";             
+            m_checkFile << "Wavelength  = "   << field.Wavelength << "\n";
+            m_checkFile << "Start       = ["  << field.Start[0] << " "
+                        << field.Start[1]   << " " << field.Start[2] << "]\n";
+            m_checkFile << "Focus       = ["  << field.Focus[0] << " "
+                        << field.Focus[1]   << " " << field.Focus[2] << "]\n";
+            m_checkFile << "\n\n";
+        }                                                                   
+    } else if (field.Type == "focusing")
+    {
+        field.MaxE = m_reader->GetReal(section, "e_max", 0) / m_units->RefEField();
+        field.Wavelength = m_reader->GetReal(section, "wavelength", 1) / m_units->RefLength();
+        field.Duration = m_reader->GetReal(section, "duration", 1) / m_units->RefTime();
+        field.Waist = m_reader->GetReal(section, "waist", 1) / m_units->RefLength();
+        field.Polerisation = m_reader->GetReal(section, "polerisation", 0);
+        field.Start = m_reader->GetThreeVector(section, "start", ThreeVector(0,0,0)) 
+                                                                / m_units->RefLength();
+        field.Focus = m_reader->GetThreeVector(section, "focus", ThreeVector(0,0,0))
+                                                                / m_units->RefLength();
+        if (m_checkOutput == true)
+        {
+            m_checkFile << "Field input parameters \n";
+            m_checkFile << "Field type  = "   << field.Type << "\n";
+            m_checkFile << "Max E       = "   << field.MaxE << "\n";
+            m_checkFile << "Duration    = "   << field.Duration << "\n";
+            m_checkFile << "Waist       = "   << field.Waist << "\n";             
+            m_checkFile << "Wavelength  = "   << field.Wavelength << "\n";
+            m_checkFile << "Start       = ["  << field.Start[0] << " "
+                        << field.Start[1]   << " " << field.Start[2] << "]\n";
+            m_checkFile << "Focus       = ["  << field.Focus[0] << " "
+                        << field.Focus[1]   << " " << field.Focus[2] << "]\n";
+            m_checkFile << "\n\n";
+        }                                                                   
+    } else if (field.Type == "grid")
+    {
+        // The grid file is in the units of the input file
+        field.GridFile = m_reader->GetString(section, "grid_file", "");
+        field.GridSlices = m_reader->GetInteger(section, "grid_slices", 4);
+        field.GridLength = 1.0 / m_units->RefLength();
+        field.GridTime = 1.0 / m_units->RefTime();
+        field.GridE = 1.0 / m_units->RefEField();
+        field.GridB = 1.0 / m_units->RefBField();
+        if (m_checkOutput == true)
+        {
+            m_checkFile << "Field input parameters \n";
+            m_checkFile << "Field type  = "   << field.Type << "\n";
+            m_checkFile << "Grid file   = "   << field.GridFile << "\n";
+            m_checkFile << "Slices held = "   << field.GridSlices << "\n";
+            m_checkFile << "\n\n";
+        }
+    }
+
+    // Optional interpolation of the field from a cached grid
+    field.CacheSpacing = m_reader->GetReal(section, "cache_spacing", 0)
+                                                / m_units->RefLength();
+    field.CacheTimeStep = m_reader->GetReal(section, "cache_time_step", 0)
+                                                / m_units->RefTime();
+    if (field.CacheTimeStep <= 0) field.CacheTimeStep = field.CacheSpacing;
+    field.CacheBrick = m_reader->GetInteger(section, "cache_brick", 8);
+    field.CacheMemory = m_reader->GetReal(section, "cache_memory", 1024);
+    field.CacheInterpolation = m_reader->GetString(section,
+                                    "cache_interpolation", "linear");
+    if (field.CacheInterpolation != "linear"
+        && field.CacheInterpolation != "cubic")
+    {
+        std::cerr << "Input error: Cache interpolation \"" << field.CacheInterpolation
+                  << "\" is not recognise.\n";
+        std::cerr << "Exiting!\n";
+        exit(1);
+    }
+    if (field.CacheSpacing > 0 && m_checkOutput == true)
+    {
+        m_checkFile << "Field cache parameters \n";
+        m_checkFile << "Spacing       = " << field.CacheSpacing << "\n";
+        m_checkFile << "Time step     = " << field.CacheTimeStep << "\n";
+        m_checkFile << "Brick size    = " << field.CacheBrick << "\n";
+        m_checkFile << "Memory (MB)   = " << field.CacheMemory << "\n";
+        m_checkFile << "Interpolation = " << field.CacheInterpolation << "\n";
+        m_checkFile << "\n\n";
+    }
+
+    return field;
+}
+
 void FileParser::ReadPhysics()
 {
 
     m_physics.Physics = m_reader->GetString("Physics", "radiation_model", "");
+    m_physics.Pusher = m_reader->GetString("Physics", "pusher", "RK4");
     m_physics.MinEnergy = m_reader->GetReal("Physics", "min_energy", 0) / m_units->RefEnergy();
     m_physics.SampleFraction = m_reader->GetReal("Physics", "sample_fraction", 1);
     m_physics.PairProduction = m_reader->GetBoolean("Physics", "pair_production", false);
@@ -191,6 +272,7 @@ void FileParser::ReadPhysics()
     {
         m_checkFile << "Physics parameters \n";
         m_checkFile << "Physics module used   = " << m_physics.Physics << "\n";
+        m_checkFile << "Particle pusher       = " << m_physics.Pusher << "\n";
         m_checkFile << "Pair production       = " << m_physics.PairProduction << "\n";
         m_checkFile << "Sample fraction       = " << m_physics.SampleFraction << "\n";
         m_checkFile << "Minimum photon energy = " << m_physics.MinEnergy << "\n";
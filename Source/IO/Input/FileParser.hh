@@ -13,6 +13,12 @@ struct GeneralParameters
     double timeEnd;         // end of simulation
     std::string fileName;   // Output file name
     bool tracking;          // Turns on particle tracking
+    unsigned int seed;      // Random seed of the run
+    bool adaptiveStep;      // Leptons choose their own time step
+    double minTimeStep;     // shortest time step a lepton chooses
+    double gyroFraction;    // longest lepton time step in gyro-periods
+    double maxOpticalDepth; // largest optical depth used in a lepton step
+    unsigned int splitParticles; // smallest event split between threads
 };
 
 struct FieldParameters
@@ -28,6 +34,17 @@ struct FieldParameters
     ThreeVector Direction;  // plane field direction
     ThreeVector Start;      // start point of laser pulse
     ThreeVector Focus;      // focus point of laser
+    std::string GridFile;   // HDF5 file of a gridded field
+    unsigned int GridSlices;    // time slices of the grid held in memory
+    double GridLength;      // length unit of the grid file in code units
+    double GridTime;        // time unit of the grid file in code units
+    double GridE;           // E field unit of the grid file in code units
+    double GridB;           // B field unit of the grid file in code units
+    double CacheSpacing;    // grid spacing of the field cache, 0 for no cache
+    double CacheTimeStep;   // grid time step of the field cache
+    unsigned int CacheBrick;    // cells along each side of a cache brick
+    double CacheMemory;     // memory budget of the cache in MB
+    std::string CacheInterpolation; // linear or cubic
 };
 
 struct ParticleParameters
@@ -49,6 +66,7 @@ struct ParticleParameters
 struct PhysicsParameters
 {
     std::string Physics;    // Select radiation physics
+    std::string Pusher;     // Particle pusher, RK4, Boris, Vay or HigueraCary
     double MinEnergy;       // Min energy of tracked particle
     double SampleFraction;  // Down samples 
     bool PairProduction;    // Turn on nonlinear Breit-Wheeler
@@ -74,7 +92,13 @@ public:
 
     GeneralParameters GetGeneral() const {return m_general;}
 
-    FieldParameters GetField() const {return m_field;}
+    // The first field section, all of them are given by GetFields
+    FieldParameters GetField() const
+    {
+        return m_fields.empty() ? FieldParameters() : m_fields[0];
+    }
+
+    std::vector<FieldParameters> GetFields() const {return m_fields;}
 
     PhysicsParameters GetPhysics() const {return m_physics;}
 
@@ -92,6 +116,8 @@ private:
 
     void ReadField();
 
+    FieldParameters ReadFieldSection(const std::string& section);
+
     void ReadPhysics();
 
     void ReadParticles();
@@ -101,7 +127,7 @@ private:
 private:
     std::vector<std::string> m_sections;
     GeneralParameters m_general;
-    FieldParameters m_field;
+    std::vector<FieldParameters> m_fields;
     PhysicsParameters m_physics;
     std::vector<ParticleParameters> m_particles;
     std::vector<HistogramParameters> m_histograms;
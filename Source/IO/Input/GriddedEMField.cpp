@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#include "GriddedEMField.hh"
+
+namespace
+{
+    const char* componentNames[6] = {"E0", "E1", "E2", "B0", "B1", "B2"};
+
+    // Reads a dataset of a grid file into data, exits if it is missing or not
+    // the expected size
+    void ReadDataset(H5::H5File* file, const std::string& fileName,
+        const std::string& name, std::vector<double>& data, std::size_t size)
+    {
+        try
+        {
+            H5::DataSet set = file->openDataSet(name);
+            std::size_t points = set.getSpace().getSimpleExtentNpoints();
+            if (size == 0) size = points;
+            if (points != size)
+            {
+                std::cerr << "Error: Dataset " << name << " in field file "
+                    << fileName << " has " << points << " points, expected "
+                    << size << ".\n";
+                exit(1);
+            }
+            data.resize(size);
+            set.read(data.data(), H5::PredType::NATIVE_DOUBLE);
+        } catch (const H5::Exception& error)
+        {
+            std::cerr << "Error: Failed to read " << name << " from field file "
+                << fileName << ".\n";
+            exit(1);
+        }
+    }
+}
+
+GriddedEMField::GriddedEMField(const std::string& fileName,
+    double lengthScale, double timeScale, double eScale, double bScale,
+    unsigned int maxSlices):
+m_fileName(fileName), m_eScale(eScale), m_bScale(bScale),
+m_maxSlices(std::max(maxSlices, 3u)), m_stop(false)
+{
+    H5::Exception::dontPrint();
+    try
+    {
+        m_file = new H5::H5File(m_fileName, H5F_ACC_RDONLY);
+    } catch (const H5::Exception& error)
+    {
+        std::cerr << "Error: Failed to open field file " << m_fileName << ".\n";
+        exit(1);
+    }
+
+    const char* axisNames[4] = {"t", "x", "y", "z"};
+    TableAxis* axes[4] = {&m_tAxis, &m_xAxis, &m_yAxis, &m_zAxis};
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        std::vector<double> points;
+        ReadDataset(m_file, m_fileName, std::string("Fields/") + axisNames[i],
+            points, 0);
+        double scale = i == 0 ? timeScale : lengthScale;
+        for (unsigned int j = 0; j < points.size(); j++)
+        {
+            points[j] *= scale;
+            if (j > 0 && !(points[j] > points[j-1]))
+            {
+                std::cerr << "Error: Axis " << axisNames[i] << " of field file "
+                    << m_fileName << " is not increasing.\n";
+                exit(1);
+            }
+        }
+        if (points.size() < 2)
+        {
+            std::cerr << "Error: Axis " << axisNames[i] << " of field file "
+                << m_fileName << " needs at least two points.\n";
+            exit(1);
+        }
+        axes[i]->Assign(points.data(), points.size());
+    }
+    m_nodes = m_xAxis.Size() * m_yAxis.Size() * m_zAxis.Size();
+
+    m_prefetcher = std::thread(&GriddedEMField::PrefetchLoop, this);
+}
+
+GriddedEMField::~GriddedEMField()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_prefetcher.join();
+    delete m_file;
+}
+
+void GriddedEMField::GetField(double time, const ThreeVector &position,
+    ThreeVector &eField, ThreeVector &bField) const
+{
+    double coord[4] = {time, position[0], position[1], position[2]};
+    unsigned int cell[4];
+    double frac[4];
+    double field[6] = {0, 0, 0, 0, 0, 0};
+    if (Locate(coord, cell, frac))
+    {
+        std::shared_ptr<const Slice> before = GetSlice(cell[0]);
+        std::shared_ptr<const Slice> after = GetSlice(cell[0] + 1);
+        Prefetch(cell[0] + 2);
+        AddSlice(*before, cell + 1, frac + 1, 1.0 - frac[0], field);
+        AddSlice(*after, cell + 1, frac + 1, frac[0], field);
+    }
+    eField = ThreeVector(field[0], field[1], field[2]);
+    bField = ThreeVector(field[3], field[4], field[5]);
+}
+
+void GriddedEMField::GetFields(FieldBatch &batch) const
+{
+    // The points of a batch are usually between the same slices, so they are
+    // only looked up again when the interval changes
+    std::shared_ptr<const Slice> before, after;
+    unsigned int interval = 0;
+    for (unsigned int i = 0; i < batch.size; i++)
+    {
+        double coord[4] = {batch.time[i], batch.xPos[i], batch.yPos[i],
+            batch.zPos[i]};
+        unsigned int cell[4];
+        double frac[4];
+        double field[6] = {0, 0, 0, 0, 0, 0};
+        if (Locate(coord, cell, frac))
+        {
+            if (!before || cell[0] != interval)
+            {
+                interval = cell[0];
+                before = GetSlice(interval);
+                after = GetSlice(interval + 1);
+                Prefetch(interval + 2);
+            }
+            AddSlice(*before, cell + 1, frac + 1, 1.0 - frac[0], field);
+            AddSlice(*after, cell + 1, frac + 1, frac[0], field);
+        }
+        batch.xE[i] = field[0];
+        batch.yE[i] = field[1];
+        batch.zE[i] = field[2];
+        batch.xB[i] = field[3];
+        batch.yB[i] = field[4];
+        batch.zB[i] = field[5];
+    }
+}
+
+bool GriddedEMField::InSupport(double time, const ThreeVector &position) const
+{
+    double coord[4] = {time, position[0], position[1], position[2]};
+    const TableAxis* axes[4] = {&m_tAxis, &m_xAxis, &m_yAxis, &m_zAxis};
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        if (!(coord[i] >= axes[i]->Front() && coord[i] <= axes[i]->Back()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+double GriddedEMField::EntryTime(double time, const ThreeVector &position,
+    const ThreeVector &velocity) const
+{
+    // Intersection of the times inside each slab of the box and the grid
+    double never = std::numeric_limits<double>::infinity();
+    double enter = std::max(time, m_tAxis.Front());
+    double exit = m_tAxis.Back();
+    const TableAxis* axes[3] = {&m_xAxis, &m_yAxis, &m_zAxis};
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        double low = axes[i]->Front(), high = axes[i]->Back();
+        if (velocity[i] == 0)
+        {
+            if (position[i] < low || position[i] > high) return never;
+            continue;
+        }
+        double first = time + (low - position[i]) / velocity[i];
+        double second = time + (high - position[i]) / velocity[i];
+        enter = std::max(enter, std::min(first, second));
+        exit = std::min(exit, std::max(first, second));
+    }
+    return enter <= exit ? enter : never;
+}
+
+std::shared_ptr<const GriddedEMField::Slice> GriddedEMField::GetSlice(
+    unsigned int index) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        auto found = m_slices.find(index);
+        if (found != m_slices.end())
+        {
+            m_recent.remove(index);
+            m_recent.push_front(index);
+            return found->second;
+        }
+        // Wait for a read already under way rather than repeating it
+        if (m_loading.count(index) == 0) break;
+        m_loaded.wait(lock);
+    }
+    m_loading.insert(index);
+    lock.unlock();
+    std::shared_ptr<const Slice> slice = ReadSlice(index);
+    Store(index, slice);
+    return slice;
+}
+
+void GriddedEMField::Prefetch(unsigned int index) const
+{
+    if (index >= m_tAxis.Size()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_slices.count(index) > 0 || m_loading.count(index) > 0) return;
+        m_loading.insert(index);
+        m_queue.push_back(index);
+    }
+    m_wake.notify_one();
+}
+
+std::shared_ptr<const GriddedEMField::Slice> GriddedEMField::ReadSlice(
+    unsigned int index) const
+{
+    std::shared_ptr<Slice> slice = std::make_shared<Slice>(6 * m_nodes);
+    std::string group = "Fields/" + std::to_string(index) + "/";
+    std::vector<double> component;
+    for (unsigned int c = 0; c < 6; c++)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_fileMutex);
+            ReadDataset(m_file, m_fileName, group + componentNames[c],
+                component, m_nodes);
+        }
+        double scale = c < 3 ? m_eScale : m_bScale;
+        double* out = slice->data() + c * m_nodes;
+        for (std::size_t i = 0; i < m_nodes; i++)
+        {
+            out[i] = scale * component[i];
+        }
+    }
+    return slice;
+}
+
+void GriddedEMField::Store(unsigned int index,
+    std::shared_ptr<const Slice> slice) const
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slices[index] = slice;
+        m_recent.push_front(index);
+        m_loading.erase(index);
+        while (m_slices.size() > m_maxSlices)
+        {
+            // Threads still using a dropped slice keep it alive
+            m_slices.erase(m_recent.back());
+            m_recent.pop_back();
+        }
+    }
+    m_loaded.notify_all();
+}
+
+void GriddedEMField::PrefetchLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_wake.wait(lock, [this]{return m_stop || !m_queue.empty();});
+        if (m_stop) return;
+        unsigned int index = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        Store(index, ReadSlice(index));
+        lock.lock();
+    }
+}
+
+bool GriddedEMField::Locate(const double* coord, unsigned int* cell,
+    double* frac) const
+{
+    const TableAxis* axes[4] = {&m_tAxis, &m_xAxis, &m_yAxis, &m_zAxis};
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        const TableAxis& axis = *axes[i];
+        if (!(coord[i] >= axis.Front() && coord[i] <= axis.Back())) return false;
+        cell[i] = axis.Interval(coord[i]);
+        frac[i] = (coord[i] - axis[cell[i]])
+            / (axis[cell[i] + 1] - axis[cell[i]]);
+    }
+    return true;
+}
+
+void GriddedEMField::AddSlice(const Slice& slice, const unsigned int* cell,
+    const double* frac, double weight, double* field) const
+{
+    std::size_t nY = m_yAxis.Size(), nZ = m_zAxis.Size();
+    std::size_t corner = (cell[0] * nY + cell[1]) * nZ + cell[2];
+    std::size_t offsets[8] = {0, 1, nZ, nZ + 1, nY * nZ, nY * nZ + 1,
+        nY * nZ + nZ, nY * nZ + nZ + 1};
+    double weights[8];
+    for (unsigned int i = 0; i < 8; i++)
+    {
+        weights[i] = weight * (i & 4 ? frac[0] : 1.0 - frac[0])
+            * (i & 2 ? frac[1] : 1.0 - frac[1])
+            * (i & 1 ? frac[2] : 1.0 - frac[2]);
+    }
+    for (unsigned int c = 0; c < 6; c++)
+    {
+        const double* values = slice.data() + c * m_nodes + corner;
+        double sum = 0;
+        for (unsigned int i = 0; i < 8; i++)
+        {
+            sum += weights[i] * values[offsets[i]];
+        }
+        field[c] += sum;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef GRIDDEDEMFIELD_HH
+#define GRIDDEDEMFIELD_HH
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "H5Cpp.h"
+#include "EMField.hh"
+#include "LookupTable.hh"
+
+/* Field read from a rectilinear grid in an HDF5 file, e.g. the output of a
+   PIC code. The file holds the axes as 1D datasets Fields/t, Fields/x,
+   Fields/y and Fields/z, and each time slice n as the 3D datasets
+   Fields/n/E0 ... Fields/n/B2 indexed [x][y][z], the layout written by
+   OutputManager::OutEMField. Only the slices bracketing the times being
+   asked for are held in memory, at most maxSlices of them, and the slice
+   after those is read ahead by a background thread. The field is trilinear
+   in space, linear in time and zero outside the grid. The scales convert
+   the values in the file to code units. */
+class GriddedEMField: public EMField
+{
+public:
+    GriddedEMField(const std::string& fileName, double lengthScale = 1,
+        double timeScale = 1, double eScale = 1, double bScale = 1,
+        unsigned int maxSlices = 4);
+
+    ~GriddedEMField();
+
+    void GetField(double time, const ThreeVector &position,
+        ThreeVector &eField, ThreeVector &bField) const override;
+
+    void GetFields(FieldBatch &batch) const override;
+
+    // Inside the grid
+    bool InSupport(double time, const ThreeVector &position) const override;
+
+    // When the particle enters the box of the grid while it is in time
+    double EntryTime(double time, const ThreeVector &position,
+        const ThreeVector &velocity) const override;
+
+    unsigned int GetNSlices() const {return m_tAxis.Size();}
+
+private:
+    // The six components one after the other, each in the order of the file
+    typedef std::vector<double> Slice;
+
+    // Returns slice index, reading it if it is not held
+    std::shared_ptr<const Slice> GetSlice(unsigned int index) const;
+
+    // Queues a slice to be read by the background thread
+    void Prefetch(unsigned int index) const;
+
+    std::shared_ptr<const Slice> ReadSlice(unsigned int index) const;
+
+    // Holds a slice that has been read, dropping the least recently used
+    void Store(unsigned int index, std::shared_ptr<const Slice> slice) const;
+
+    void PrefetchLoop();
+
+    // Finds the cell of a point, false if it is outside the grid
+    bool Locate(const double* coord, unsigned int* cell, double* frac) const;
+
+    // Adds weight times the trilinear interpolation of a slice to field
+    void AddSlice(const Slice& slice, const unsigned int* cell,
+        const double* frac, double weight, double* field) const;
+
+private:
+    std::string m_fileName;
+    H5::H5File* m_file;
+    TableAxis m_tAxis;
+    TableAxis m_xAxis;
+    TableAxis m_yAxis;
+    TableAxis m_zAxis;
+    std::size_t m_nodes;        // Nodes in each slice
+    double m_eScale;
+    double m_bScale;
+    unsigned int m_maxSlices;
+
+    mutable std::mutex m_fileMutex;     // HDF5 is not thread safe
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_loaded;
+    mutable std::condition_variable m_wake;
+    mutable std::map<unsigned int, std::shared_ptr<const Slice> > m_slices;
+    mutable std::list<unsigned int> m_recent;   // most recently used first
+    mutable std::set<unsigned int> m_loading;   // being read or queued
+    mutable std::deque<unsigned int> m_queue;   // to be read ahead
+    bool m_stop;
+    std::thread m_prefetcher;
+};
+#endif
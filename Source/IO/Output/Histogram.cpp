@@ -1,5 +1,4 @@
 #include "Histogram.hh"
-#include "Numerics.hh"
 
 Histogram::Histogram():
 m_nBins(0), m_entries(0), m_binCentres(NULL), m_binValues(NULL)
@@ -26,6 +25,7 @@ void Histogram::Initialise(std::string name, std::string particle , std::string
 	m_type = type;
 	m_time = time;
 	m_nBins = nBins;
+	m_entries = 0;
 	m_binCentres = new double [nBins];
 	m_binValues  = new double [m_nBins];
 	double detla = (maxBin - minBin) / (m_nBins - 1.0);
@@ -34,9 +34,36 @@ void Histogram::Initialise(std::string name, std::string particle , std::string
 		m_binCentres[i] = minBin + i * detla;
 		m_binValues[i] = 0;
 	}
+	m_binAxis.AssignUniform(minBin, maxBin, m_nBins);
+	SetThreads(m_shards.GetNShards());
 }
 
-void Histogram::AppParticle(Particle* part)
+void Histogram::SetThreads(unsigned int nThreads)
+{
+	m_shards.Resize(nThreads);
+	for (unsigned int i = 0; i < m_shards.GetNShards(); i++)
+	{
+		m_shards[i].values.assign(m_nBins, 0);
+		m_shards[i].entries = 0;
+	}
+}
+
+void Histogram::MergeShards()
+{
+	for (unsigned int i = 0; i < m_shards.GetNShards(); i++)
+	{
+		HistogramShard& shard = m_shards[i];
+		for (unsigned int j = 0; j < m_nBins; j++)
+		{
+			m_binValues[j] += shard.values[j];
+			shard.values[j] = 0;
+		}
+		m_entries += shard.entries;
+		shard.entries = 0;
+	}
+}
+
+void Histogram::AppParticle(ParticleList* partList, unsigned int index)
 {
 	if (m_nBins == 0)
 	{
@@ -44,68 +71,69 @@ void Histogram::AppParticle(Particle* part)
 		exit(1);
 	} else
 	{
+		HistogramShard& shard = m_shards.Local();
 		if (m_type == "Energy" || "energy")
 		{
-			m_entries++;
-			double energy = part->GetEnergy();
+			shard.entries++;
+			double energy = partList->GetEnergy(index);
 			if (energy > m_binCentres[0] && energy < m_binCentres[m_nBins-1])
 			{
-				unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, energy);
-				m_binValues[index]++;
+				unsigned int bin = m_binAxis.ArrayIndex(energy);
+				shard.values[bin]++;
 			}
 		} else if (m_type == "X" || "x")
 		{
-			m_entries++;
-			double xPos = part->GetPosition()[0];
+			shard.entries++;
+			double xPos = partList->GetPosition(index)[0];
 			if (xPos > m_binCentres[0] && xPos < m_binCentres[m_nBins-1])
 			{
-				unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, xPos);
-				m_binValues[index]++;
+				unsigned int bin = m_binAxis.ArrayIndex(xPos);
+				shard.values[bin]++;
 			}
 		} else if (m_type == "Y" || "y")
 		{
-			m_entries++;
-			double yPos = part->GetPosition()[1];
+			shard.entries++;
+			double yPos = partList->GetPosition(index)[1];
 			if (yPos > m_binCentres[0] && yPos < m_binCentres[m_nBins-1])
 			{
-				unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, yPos);
-				m_binValues[index]++;
+				unsigned int bin = m_binAxis.ArrayIndex(yPos);
+				shard.values[bin]++;
 			}
 		} else if (m_type == "Z" || "z")
 		{
-			m_entries++;
-			double zPos =  part->GetPosition()[2];
+			shard.entries++;
+			double zPos =  partList->GetPosition(index)[2];
 			if (zPos > m_binCentres[0] && zPos < m_binCentres[m_nBins-1])
 			{
-				unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, zPos);
-				m_binValues[index]++;
+				unsigned int bin = m_binAxis.ArrayIndex(zPos);
+				shard.values[bin]++;
 			}
 		} else if (m_type == "PX" || "px")
 		{
-			m_entries++;
-			double xPos = part->GetMomentum()[0];
+			shard.entries++;
+			double xPos = partList->GetMomentum(index)[0];
 			if (xPos > m_binCentres[0] && xPos < m_binCentres[m_nBins-1])
 			{
-				unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, xPos);
-				m_binValues[index]++;
+				unsigned int bin = m_binAxis.ArrayIndex(xPos);
+				shard.values[bin]++;
 			}
 		} else if (m_type == "PY" || "py")
 		{
-			m_entries++;
-			double yPos = part->GetMomentum()[1];
+			shard.entries++;
+			double yPos = partList->GetMomentum(index)[1];
 			if (yPos > m_binCentres[0] && yPos < m_binCentres[m_nBins-1])
 			{
-				unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, yPos);
-				m_binValues[index]++;
+				unsigned int bin = m_binAxis.ArrayIndex(yPos);
+				shard.values[bin]++;
 			}
 		} else if (m_type == "PZ" || "pz")
 		{
-			m_entries++;
-			double zPos =  part->GetMomentum()[2];
+			shard.entries++;
+			double zPos =  partList->GetMomentum(index)[2];
 			if (zPos > m_binCentres[0] && zPos < m_binCentres[m_nBins-1])
 			{
-				unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, zPos);
-				m_binValues[index]++;
+				unsigned int bin = m_binAxis.ArrayIndex(zPos);
+				shard.values[bin]++;
 			}		
 		} else
 		{
@@ -128,10 +156,10 @@ void Histogram::Fill(ParticleList* partList)
 			for (unsigned int i = 0; i < partList->GetNPart(); i++)
 			{
 				m_entries++;
-				double energy =  partList->GetParticle(i)->GetEnergy();
+				double energy =  partList->GetEnergy(i);
 				if (energy > m_binCentres[0] && energy < m_binCentres[m_nBins-1])
 				{
-					unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, energy);
+					unsigned int index = m_binAxis.ArrayIndex(energy);
 					m_binValues[index]++;
 				}
 			}
@@ -141,10 +169,10 @@ void Histogram::Fill(ParticleList* partList)
 			for (unsigned int i = 0; i < partList->GetNPart(); i++)
 			{
 				m_entries++;
-				double xPos =  partList->GetParticle(i)->GetPosition()[0];
+				double xPos =  partList->GetPosition(i)[0];
 				if (xPos > m_binCentres[0] && xPos < m_binCentres[m_nBins-1])
 				{
-					unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, xPos);
+					unsigned int index = m_binAxis.ArrayIndex(xPos);
 					m_binValues[index]++;
 				}
 			}
@@ -153,10 +181,10 @@ void Histogram::Fill(ParticleList* partList)
 			for (unsigned int i = 0; i < partList->GetNPart(); i++)
 			{
 				m_entries++;
-				double yPos =  partList->GetParticle(i)->GetPosition()[1];
+				double yPos =  partList->GetPosition(i)[1];
 				if (yPos > m_binCentres[0] && yPos < m_binCentres[m_nBins-1])
 				{
-					unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, yPos);
+					unsigned int index = m_binAxis.ArrayIndex(yPos);
 					m_binValues[index]++;
 				}
 			}
@@ -165,10 +193,10 @@ void Histogram::Fill(ParticleList* partList)
 			for (unsigned int i = 0; i < partList->GetNPart(); i++)
 			{
 				m_entries++;
-				double zPos =  partList->GetParticle(i)->GetPosition()[2];
+				double zPos =  partList->GetPosition(i)[2];
 				if (zPos > m_binCentres[0] && zPos < m_binCentres[m_nBins-1])
 				{
-					unsigned int index = Numerics::ArrayIndex(m_binCentres, m_nBins, zPos);
+					unsigned int index = m_binAxis.ArrayIndex(zPos);
 					m_binValues[index]++;
 				}
 			}
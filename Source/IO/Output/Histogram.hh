@@ -2,7 +2,10 @@
 #define HISTOGRAM_HH
 
 #include <string>
+#include <vector>
 #include "ParticleList.hh"
+#include "LookupTable.hh"
+#include "ThreadShards.hh"
 
 class Histogram
 {
@@ -17,7 +20,15 @@ public:
 	void Initialise(std::string name, std::string particle, std::string type, double time,
 					double minBin, double maxBin, unsigned int nBins);
 
-	void AppParticle(Particle* part);
+	// Gives each of nThreads threads its own bins, so AppParticle can be
+	// called from every thread at once. Drops anything not yet merged
+	void SetThreads(unsigned int nThreads);
+
+	// Adds a particle to the bins of the calling thread
+	void AppParticle(ParticleList* partList, unsigned int index);
+
+	// Adds the bins of every thread to the histogram, in thread order
+	void MergeShards();
 
 	void Fill(ParticleList* partList);
 
@@ -47,5 +58,13 @@ private:
 	double m_time;
 	double* m_binCentres;
 	double* m_binValues;
+	TableAxis m_binAxis;	// uniform axis of bin centres
+
+	struct HistogramShard
+	{
+		std::vector<double> values;
+		unsigned int entries;
+	};
+	ThreadShards<HistogramShard> m_shards;	// per thread, merged into the above
 };
 #endif
\ No newline at end of file
@@ -58,14 +58,15 @@ OutputManager::~OutputManager()
     }
 }
 
-void OutputManager::SingleParticle(Particle* part, std::string name)
+void OutputManager::SingleParticle(ParticleList* partList, unsigned int index,
+    std::string name)
 {
     if (m_singlePartBool == false)
     {
         m_outputFile->AddGroup("Particles/Single");
         m_singlePartBool = true;
     }
-    if (part->GetTracking() == false)
+    if (partList->GetTracking(index) == false)
     {
         std::cerr << "Error: Failed to output data for particle \"" + name + "\".\n"; 
         std::cerr << "       Tracking set to false for this particle.\n";
@@ -85,14 +86,15 @@ void OutputManager::SingleParticle(Particle* part, std::string name)
             time = m_units->RefTime();
         }
 
-        double posBuff[3*part->GetPosHist().size()];
-        double momBuff[3*part->GetMomHist().size()];
-        double timeBuff[part->GetTimeHist().size()];
-        double gammaBuff[part->GetGammaHist().size()];      
-        for (unsigned int i = 0; i < part->GetPosHist().size(); i++)
+        const ParticleTrack& track = partList->GetTrack(index);
+        double posBuff[3*track.position.size()];
+        double momBuff[3*track.momentum.size()];
+        double timeBuff[track.time.size()];
+        double gammaBuff[track.gamma.size()];      
+        for (unsigned int i = 0; i < track.position.size(); i++)
         {
-            ThreeVector pos = part->GetPosHist()[i];
-            ThreeVector mom = part->GetMomHist()[i];
+            ThreeVector pos = track.position[i];
+            ThreeVector mom = track.momentum[i];
             posBuff[3*i]   = pos[0] * length;
             posBuff[3*i+1] = pos[1] * length;
             posBuff[3*i+2] = pos[2] * length;
@@ -100,20 +102,20 @@ void OutputManager::SingleParticle(Particle* part, std::string name)
             momBuff[3*i+1] = mom[1] * momentum;
             momBuff[3*i+2] = mom[2] * momentum;
         }
-        for (unsigned int i = 0; i < part->GetTimeHist().size(); i++)
+        for (unsigned int i = 0; i < track.time.size(); i++)
         {
-            timeBuff[i] = part->GetTimeHist()[i] * time;
+            timeBuff[i] = track.time[i] * time;
         }
-        for (unsigned int i = 0; i < part->GetGammaHist().size(); i++)
+        for (unsigned int i = 0; i < track.gamma.size(); i++)
         {
-            gammaBuff[i] = part->GetGammaHist()[i];
+            gammaBuff[i] = track.gamma[i];
         }
         std::string groupName = "Particles/Single/" + name;
         m_outputFile->AddGroup(groupName);
-        m_outputFile->AddArray2D(posBuff, part->GetPosHist().size(), 3, groupName + "/Position");
-        m_outputFile->AddArray2D(momBuff, part->GetMomHist().size(), 3, groupName + "/Momentum");
-        m_outputFile->AddArray1D(timeBuff, part->GetTimeHist().size(), groupName + "/Time");
-        m_outputFile->AddArray1D(gammaBuff, part->GetGammaHist().size(), groupName + "/Gamma");
+        m_outputFile->AddArray2D(posBuff, track.position.size(), 3, groupName + "/Position");
+        m_outputFile->AddArray2D(momBuff, track.momentum.size(), 3, groupName + "/Momentum");
+        m_outputFile->AddArray1D(timeBuff, track.time.size(), groupName + "/Time");
+        m_outputFile->AddArray1D(gammaBuff, track.gamma.size(), groupName + "/Gamma");
     }
 }
 
@@ -127,8 +129,7 @@ void OutputManager::ListTracks(ParticleList* partList, std::string name)
     m_outputFile->AddGroup("Particles/ParticleList/" + name);
     for (unsigned int i = 0; i < partList->GetNPart(); i++)
     {
-        Particle* part = partList->GetParticle(i);
-        if (part->GetTracking() == false)
+        if (partList->GetTracking(i) == false)
         {
             std::cerr << "Error: Failed to output data for particle \"" << name 
                       << " " << i << "\".\n"; 
@@ -149,38 +150,39 @@ void OutputManager::ListTracks(ParticleList* partList, std::string name)
                 time = m_units->RefTime();
             }
 
-            double posBuff[3*part->GetPosHist().size()];
-            double momBuff[3*part->GetMomHist().size()];
-            double timeBuff[part->GetTimeHist().size()];
-            double gammaBuff[part->GetGammaHist().size()];      
-            for (unsigned int i = 0; i < part->GetPosHist().size(); i++)
+            const ParticleTrack& track = partList->GetTrack(i);
+            double posBuff[3*track.position.size()];
+            double momBuff[3*track.momentum.size()];
+            double timeBuff[track.time.size()];
+            double gammaBuff[track.gamma.size()];      
+            for (unsigned int i = 0; i < track.position.size(); i++)
             {
                 for (unsigned int j = 0; j < 3; j++)
                 {
-                    posBuff[3*i+j] = part->GetPosHist()[i][j] * length;
+                    posBuff[3*i+j] = track.position[i][j] * length;
                 }
             }
-            for (unsigned int i = 0; i < part->GetMomHist().size(); i++)
+            for (unsigned int i = 0; i < track.momentum.size(); i++)
             {
                 for (unsigned int j = 0; j < 3; j++)
                 {
-                    momBuff[3*i+j] = part->GetMomHist()[i][j] * momentum;
+                    momBuff[3*i+j] = track.momentum[i][j] * momentum;
                 }
             }
-            for (unsigned int i = 0; i < part->GetTimeHist().size(); i++)
+            for (unsigned int i = 0; i < track.time.size(); i++)
             {
-                timeBuff[i] = part->GetTimeHist()[i] * time;
+                timeBuff[i] = track.time[i] * time;
             }
-            for (unsigned int i = 0; i < part->GetGammaHist().size(); i++)
+            for (unsigned int i = 0; i < track.gamma.size(); i++)
             {
-                gammaBuff[i] = part->GetGammaHist()[i];
+                gammaBuff[i] = track.gamma[i];
             }
             std::string groupName = "Particles/ParticleList/" + name + "/" + std::to_string(i);
             m_outputFile->AddGroup(groupName);
-            m_outputFile->AddArray2D(posBuff, part->GetPosHist().size(), 3, groupName + "/Position");
-            m_outputFile->AddArray2D(momBuff, part->GetMomHist().size(), 3, groupName + "/Momentum");
-            m_outputFile->AddArray1D(timeBuff, part->GetTimeHist().size(), groupName + "/Time");
-            m_outputFile->AddArray1D(gammaBuff, part->GetGammaHist().size(), groupName + "/Gamma");
+            m_outputFile->AddArray2D(posBuff, track.position.size(), 3, groupName + "/Position");
+            m_outputFile->AddArray2D(momBuff, track.momentum.size(), 3, groupName + "/Momentum");
+            m_outputFile->AddArray1D(timeBuff, track.time.size(), groupName + "/Time");
+            m_outputFile->AddArray1D(gammaBuff, track.gamma.size(), groupName + "/Gamma");
         }
     }
 }
@@ -199,10 +201,10 @@ void OutputManager::ListProperties(ParticleList* partList, std::string setName)
     for (unsigned int i = 0; i < partList->GetNPart(); i++)
     {
         dataBuff[i*5] = i;
-        dataBuff[i*5+1] = partList->GetParticle(i)->GetEnergy();
-        dataBuff[i*5+2] = partList->GetParticle(i)->GetPosition()[0];
-        dataBuff[i*5+3] = partList->GetParticle(i)->GetPosition()[1];
-        dataBuff[i*5+4] = partList->GetParticle(i)->GetPosition()[2];
+        dataBuff[i*5+1] = partList->GetEnergy(i);
+        dataBuff[i*5+2] = partList->GetPosition(i)[0];
+        dataBuff[i*5+3] = partList->GetPosition(i)[1];
+        dataBuff[i*5+4] = partList->GetPosition(i)[2];
     }
     m_outputFile->AddArray2D(dataBuff, partList->GetNPart(), 5, groupName + "/" + setName);
 }
@@ -224,13 +226,13 @@ void OutputManager::StoreSource(ParticleList* partList, unsigned int eventID, bo
     {
         double* dataBuff = new double[8];
         dataBuff[0] = eventID;
-        dataBuff[1] = partList->GetParticle(0)->GetEnergy(),
-        dataBuff[2] = partList->GetParticle(0)->GetMomentum()[0],
-        dataBuff[3] = partList->GetParticle(0)->GetMomentum()[1],
-        dataBuff[4] = partList->GetParticle(0)->GetMomentum()[2],
-        dataBuff[5] = partList->GetParticle(0)->GetPosition()[0],
-        dataBuff[6] = partList->GetParticle(0)->GetPosition()[1],
-        dataBuff[7] = partList->GetParticle(0)->GetPosition()[2];
+        dataBuff[1] = partList->GetEnergy(0),
+        dataBuff[2] = partList->GetMomentum(0)[0],
+        dataBuff[3] = partList->GetMomentum(0)[1],
+        dataBuff[4] = partList->GetMomentum(0)[2],
+        dataBuff[5] = partList->GetPosition(0)[0],
+        dataBuff[6] = partList->GetPosition(0)[1],
+        dataBuff[7] = partList->GetPosition(0)[2];
         m_primaryEvent[eventID] = dataBuff;
     } else
     {
@@ -239,9 +241,9 @@ void OutputManager::StoreSource(ParticleList* partList, unsigned int eventID, bo
         m_photonCount[eventID]   = 0;
         for (unsigned int i = 0; i < partList->GetNPart(); i++)
         {
-            if (partList->GetParticle(i)->GetName() == "Electron") m_electronCount[eventID]++;
-            if (partList->GetParticle(i)->GetName() == "Positron") m_positronCount[eventID]++;
-            if (partList->GetParticle(i)->GetName() == "Photon") m_photonCount[eventID]++;
+            if (partList->GetSpeciesName(i) == "Electron") m_electronCount[eventID]++;
+            if (partList->GetSpeciesName(i) == "Positron") m_positronCount[eventID]++;
+            if (partList->GetSpeciesName(i) == "Photon") m_photonCount[eventID]++;
         }
         double* electronData = new double [m_electronCount[eventID]*8];
         double* positronData = new double [m_positronCount[eventID]*8];
@@ -251,59 +253,38 @@ void OutputManager::StoreSource(ParticleList* partList, unsigned int eventID, bo
         m_photonCount[eventID] = 0;
         for (unsigned int i = 0; i < partList->GetNPart(); i++)
         {
-            if (partList->GetParticle(i)->GetName() == "Electron")
+            if (partList->GetSpeciesName(i) == "Electron")
             {
                 electronData[m_electronCount[eventID]*8]   = eventID;
-                electronData[m_electronCount[eventID]*8+1] = partList->GetParticle(i)
-                        ->GetEnergy();
-                electronData[m_electronCount[eventID]*8+2] = partList->GetParticle(i)
-                        ->GetMomentum()[0];
-                electronData[m_electronCount[eventID]*8+3] = partList->GetParticle(i)
-                        ->GetMomentum()[1];
-                electronData[m_electronCount[eventID]*8+4] = partList->GetParticle(i)
-                        ->GetMomentum()[2];
-                electronData[m_electronCount[eventID]*8+5] = partList->GetParticle(i)
-                        ->GetPosition()[0];
-                electronData[m_electronCount[eventID]*8+6] = partList->GetParticle(i)
-                        ->GetPosition()[1];
-                electronData[m_electronCount[eventID]*8+7] = partList->GetParticle(i)
-                        ->GetPosition()[2];
+                electronData[m_electronCount[eventID]*8+1] = partList->GetEnergy(i);
+                electronData[m_electronCount[eventID]*8+2] = partList->GetMomentum(i)[0];
+                electronData[m_electronCount[eventID]*8+3] = partList->GetMomentum(i)[1];
+                electronData[m_electronCount[eventID]*8+4] = partList->GetMomentum(i)[2];
+                electronData[m_electronCount[eventID]*8+5] = partList->GetPosition(i)[0];
+                electronData[m_electronCount[eventID]*8+6] = partList->GetPosition(i)[1];
+                electronData[m_electronCount[eventID]*8+7] = partList->GetPosition(i)[2];
                 m_electronCount[eventID]++;
-            } else if (partList->GetParticle(i)->GetName() == "Positron")
+            } else if (partList->GetSpeciesName(i) == "Positron")
             {
                 positronData[m_positronCount[eventID]*8]   = eventID;
-                positronData[m_positronCount[eventID]*8+1] = partList->GetParticle(i)
-                        ->GetEnergy();
-                positronData[m_positronCount[eventID]*8+2] = partList->GetParticle(i)
-                        ->GetMomentum()[0];
-                positronData[m_positronCount[eventID]*8+3] = partList->GetParticle(i)
-                        ->GetMomentum()[1];
-                positronData[m_positronCount[eventID]*8+4] = partList->GetParticle(i)
-                        ->GetMomentum()[2];
-                positronData[m_positronCount[eventID]*8+5] = partList->GetParticle(i)
-                        ->GetPosition()[0];
-                positronData[m_positronCount[eventID]*8+6] = partList->GetParticle(i)
-                        ->GetPosition()[1];
-                positronData[m_positronCount[eventID]*8+7] = partList->GetParticle(i)
-                        ->GetPosition()[2];
+                positronData[m_positronCount[eventID]*8+1] = partList->GetEnergy(i);
+                positronData[m_positronCount[eventID]*8+2] = partList->GetMomentum(i)[0];
+                positronData[m_positronCount[eventID]*8+3] = partList->GetMomentum(i)[1];
+                positronData[m_positronCount[eventID]*8+4] = partList->GetMomentum(i)[2];
+                positronData[m_positronCount[eventID]*8+5] = partList->GetPosition(i)[0];
+                positronData[m_positronCount[eventID]*8+6] = partList->GetPosition(i)[1];
+                positronData[m_positronCount[eventID]*8+7] = partList->GetPosition(i)[2];
                 m_positronCount[eventID]++;
-            }  else if (partList->GetParticle(i)->GetName() == "Photon")
+            }  else if (partList->GetSpeciesName(i) == "Photon")
             {
                 photonData[m_photonCount[eventID]*8]   = eventID;
-                photonData[m_photonCount[eventID]*8+1] = partList->GetParticle(i)
-                        ->GetEnergy();
-                photonData[m_photonCount[eventID]*8+2] = partList->GetParticle(i)
-                        ->GetMomentum()[0];
-                photonData[m_photonCount[eventID]*8+3] = partList->GetParticle(i)
-                        ->GetMomentum()[1];
-                photonData[m_photonCount[eventID]*8+4] = partList->GetParticle(i)
-                        ->GetMomentum()[2];
-                photonData[m_photonCount[eventID]*8+5] = partList->GetParticle(i)
-                        ->GetPosition()[0];
-                photonData[m_photonCount[eventID]*8+6] = partList->GetParticle(i)
-                        ->GetPosition()[1];
-                photonData[m_photonCount[eventID]*8+7] = partList->GetParticle(i)
-                        ->GetPosition()[2];
+                photonData[m_photonCount[eventID]*8+1] = partList->GetEnergy(i);
+                photonData[m_photonCount[eventID]*8+2] = partList->GetMomentum(i)[0];
+                photonData[m_photonCount[eventID]*8+3] = partList->GetMomentum(i)[1];
+                photonData[m_photonCount[eventID]*8+4] = partList->GetMomentum(i)[2];
+                photonData[m_photonCount[eventID]*8+5] = partList->GetPosition(i)[0];
+                photonData[m_photonCount[eventID]*8+6] = partList->GetPosition(i)[1];
+                photonData[m_photonCount[eventID]*8+7] = partList->GetPosition(i)[2];
                 m_photonCount[eventID]++;
             }
         }
@@ -315,14 +296,39 @@ void OutputManager::StoreSource(ParticleList* partList, unsigned int eventID, bo
 
 void OutputManager::StoreTrack(ParticleList* partList, unsigned int eventID)
 {
+    m_trackShards.BeginEvent(eventID);
     for (unsigned int i = 0; i < partList->GetNPart(); i++)
     {
+        TrackRecord record;
+        record.id = eventID;
+        if (partList->GetTracking(i) == true)
+        {
+            const ParticleTrack& track = partList->GetTrack(i);
+            record.position = track.position;
+            record.momentum = track.momentum;
+            record.time = track.time;
+            record.gamma = track.gamma;
+        }
+        m_trackShards.Add(std::move(record));
+    }
+}
 
-        m_idTrack.push_back(eventID);
-        m_positionTrack.push_back(partList->GetParticle(i)->GetPosHist());
-        m_momentumTrack.push_back(partList->GetParticle(i)->GetMomHist());
-        m_timeTrack.push_back(partList->GetParticle(i)->GetTimeHist());
-        m_gammaTrack.push_back(partList->GetParticle(i)->GetGammaHist());
+void OutputManager::SetThreads(unsigned int nThreads)
+{
+    m_trackShards.Resize(nThreads);
+}
+
+void OutputManager::MergeShards()
+{
+    std::vector<TrackRecord> records;
+    m_trackShards.MoveTo(records);
+    for (unsigned int i = 0; i < records.size(); i++)
+    {
+        m_idTrack.push_back(records[i].id);
+        m_positionTrack.push_back(std::move(records[i].position));
+        m_momentumTrack.push_back(std::move(records[i].momentum));
+        m_timeTrack.push_back(std::move(records[i].time));
+        m_gammaTrack.push_back(std::move(records[i].gamma));
     }
 }
 
@@ -502,6 +508,28 @@ void OutputManager::OutEMField(EMField* field, const std::vector<double> &tAxis,
                                const std::vector<double> &yAxis,
                                const std::vector<double> &zAxis)
 {
+    double length = 1, time = 1, eField = 1, bField = 1;
+    if (m_units != NULL)
+    {
+        length = m_units->RefLength();
+        time = m_units->RefTime();
+        eField = m_units->RefEField();
+        bField = m_units->RefBField();
+    }
+
+    // Axes, so that the fields can be read back by GriddedEMField
+    const std::vector<double>* axes[4] = {&tAxis, &xAxis, &yAxis, &zAxis};
+    std::string axisNames[4] = {"t", "x", "y", "z"};
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        std::vector<double> axis(*axes[i]);
+        for (unsigned int j = 0; j < axis.size(); j++)
+        {
+            axis[j] *= i == 0 ? time : length;
+        }
+        m_outputFile->AddArray1D(axis.data(), axis.size(), "Fields/" + axisNames[i]);
+    }
+
     for (unsigned int t = 0; t < tAxis.size(); t++)
     {
 
@@ -522,8 +550,8 @@ void OutputManager::OutEMField(EMField* field, const std::vector<double> &tAxis,
                         ThreeVector efield, bfield;
                         field->GetField(tAxis[t], ThreeVector(xAxis[i], yAxis[j], zAxis[k]),
                                        efield, bfield);
-                        dataBuffE[index] = efield[dir];
-                        dataBuffB[index] = bfield[dir];
+                        dataBuffE[index] = efield[dir] * eField;
+                        dataBuffB[index] = bfield[dir] * bField;
                     }
                 }
             }
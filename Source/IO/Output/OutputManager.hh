@@ -5,11 +5,11 @@
 #include <string>
 #include "ThreeVector.hh"
 #include "HDF5Output.hh"
-#include "Particle.hh"
 #include "ParticleList.hh"
 #include "EMField.hh"
 #include "UnitsSystem.hh"
 #include "Histogram.hh"
+#include "ThreadShards.hh"
 
 #ifdef USEMPI
     #include <mpi.h>
@@ -27,7 +27,8 @@ public:
     ~OutputManager();
 
     // Particle Output methods
-    void SingleParticle(Particle* part, std::string name);
+    void SingleParticle(ParticleList* partList, unsigned int index,
+        std::string name);
 
     // Saves the data from a tracked particle
     void ListTracks(ParticleList* partList, std::string name);
@@ -42,8 +43,17 @@ public:
 
     void StoreSource(ParticleList* partList, unsigned int eventID, bool primary);
 
+    // Stores the tracks of an event in the shard of the calling thread
     void StoreTrack(ParticleList* partList, unsigned int eventID);
 
+    // Gives each of nThreads threads its own track store, call before they
+    // start storing
+    void SetThreads(unsigned int nThreads);
+
+    // Moves the tracks stored by every thread to the output in event order,
+    // call once the events of a source are done
+    void MergeShards();
+
     void OutputEvents(bool outSource, bool outTrack);
 
     // Physics package output methods
@@ -86,5 +96,16 @@ private:
     std::vector<std::vector<ThreeVector>> m_momentumTrack;
     std::vector<std::vector<double>> m_timeTrack;
     std::vector<std::vector<double>> m_gammaTrack;
+
+    // Tracks of one particle waiting in a thread's shard
+    struct TrackRecord
+    {
+        unsigned int id;
+        std::vector<ThreeVector> position;
+        std::vector<ThreeVector> momentum;
+        std::vector<double> time;
+        std::vector<double> gamma;
+    };
+    EventShards<TrackRecord> m_trackShards;
 };
 #endif
\ No newline at end of file
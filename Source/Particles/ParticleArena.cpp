@@ -0,0 +1,47 @@
+#include "ParticleArena.hh"
+#include "ParticleList.hh"
+
+std::atomic<unsigned long> ParticleArena::m_allocations(0);
+std::atomic<unsigned long> ParticleArena::m_reuses(0);
+
+ParticleArena::ParticleArena()
+{
+}
+
+ParticleArena::~ParticleArena()
+{
+	for (unsigned int i = 0; i < m_freeChunks.size(); i++)
+	{
+		delete m_freeChunks[i];
+	}
+}
+
+ParticleArena& ParticleArena::ThreadArena()
+{
+	thread_local ParticleArena arena;
+	return arena;
+}
+
+ParticleChunk* ParticleArena::Acquire()
+{
+	if (m_freeChunks.empty() == true)
+	{
+		m_allocations.fetch_add(1, std::memory_order_relaxed);
+		return new ParticleChunk;
+	}
+	m_reuses.fetch_add(1, std::memory_order_relaxed);
+	ParticleChunk* chunk = m_freeChunks.back();
+	m_freeChunks.pop_back();
+	return chunk;
+}
+
+void ParticleArena::Release(ParticleChunk* chunk)
+{
+	m_freeChunks.push_back(chunk);
+}
+
+void ParticleArena::ResetCounters()
+{
+	m_allocations = 0;
+	m_reuses = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef PARTICLEARENA_HH
+#define PARTICLEARENA_HH
+
+#include <vector>
+#include <atomic>
+
+struct ParticleChunk;
+
+/* Per-thread pool of particle chunks. Particle lists take their chunks from
+   the arena of the calling thread and hand them back when they are
+   destroyed, so once the first few events have run no further memory is
+   requested from the system allocator. Each arena is only ever used by its
+   own thread so no locking is needed. */
+class ParticleArena
+{
+public:
+	~ParticleArena();
+
+	// Returns the arena belonging to the calling thread
+	static ParticleArena& ThreadArena();
+
+	// Hands out a free chunk, allocating a new one only if the pool is empty
+	ParticleChunk* Acquire();
+
+	// Returns a chunk to the pool
+	void Release(ParticleChunk* chunk);
+
+	unsigned int GetNFree() const {return m_freeChunks.size();}
+
+	// Counters summed over all threads
+	static unsigned long GetAllocations() {return m_allocations;}
+
+	static unsigned long GetReuses() {return m_reuses;}
+
+	static void ResetCounters();
+
+private:
+	ParticleArena();
+
+private:
+	std::vector<ParticleChunk*> m_freeChunks;
+
+	static std::atomic<unsigned long> m_allocations;	// Chunks taken from the allocator
+	static std::atomic<unsigned long> m_reuses;			// Chunks handed out from a pool
+};
+#endif
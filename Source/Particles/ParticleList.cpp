@@ -1,33 +1,197 @@
+#include <utility>
+
 #include "ParticleList.hh"
+#include "ParticleArena.hh"
 #include "MCTools.hh"
-#include "UnitsSystem.hh"
-#include "Lepton.hh"
-#include "Photon.hh"
-#include <fstream>
 
-ParticleList::ParticleList(std::string name, unsigned int maxParticles):
-m_name(name), m_maxParticles(maxParticles), m_particleNumber(0)
+namespace
+{
+	const std::string speciesNames[3] = {"Photon", "Electron", "Positron"};
+
+	// List the calling thread is staging for and where its particles go
+	thread_local ParticleList* stagedList = nullptr;
+	thread_local ParticleList* stagingList = nullptr;
+}
+
+ParticleList::ParticleList(std::string name):
+m_name(name), m_particleNumber(0), m_trackNumber(0), m_photonClock(0)
 {
-	m_particleList = std::vector<Particle*>(m_maxParticles);
 }
 
 ParticleList::~ParticleList()
 {
-	for (unsigned int i = 0; i < m_particleNumber; i++)
+	ParticleArena& arena = ParticleArena::ThreadArena();
+	for (unsigned int i = 0; i < m_chunks.size(); i++)
 	{
-		delete m_particleList[i];
+		arena.Release(m_chunks[i]);
 	}
 }
 
-void ParticleList::AddParticle(Particle *part)
+void ParticleList::Clear()
 {
-	if (m_particleNumber < m_maxParticles)
+	m_particleNumber = 0;
+	for (unsigned int i = 0; i < m_trackNumber; i++)
 	{
-		m_particleList[m_particleNumber] = part;
-		m_particleNumber++;
+		m_tracks[i].position.clear();
+		m_tracks[i].momentum.clear();
+		m_tracks[i].time.clear();
+		m_tracks[i].gamma.clear();
+	}
+	m_trackNumber = 0;
+	m_photonClock = 0;
+}
+
+unsigned int ParticleList::AddParticle(Species species,
+	const ThreeVector &position, const ThreeVector &momentum, double weight,
+	double time, bool tracking)
+{
+	if (stagedList == this)
+	{
+		return stagingList->AddParticle(species, position, momentum, weight,
+			time, tracking);
+	}
+	unsigned int index = Insert(species, position, momentum, weight, time,
+		tracking);
+	InitOpticalDepth(index);
+	return index;
+}
+
+void ParticleList::Append(ParticleList& other)
+{
+	for (unsigned int i = 0; i < other.m_particleNumber; i++)
+	{
+		const ParticleChunk* from = other.Chunk(i);
+		unsigned int slot = Slot(i);
+		bool tracking = from->trackIndex[slot] >= 0;
+		unsigned int index = Insert(from->species[slot], other.GetPosition(i),
+			other.GetMomentum(i), from->weight[slot], other.GetTime(i),
+			tracking);
+		ParticleChunk* to = Chunk(index);
+		to->opticalDepth[Slot(index)] = from->opticalDepth[slot];
+		to->isAlive[Slot(index)] = from->isAlive[slot];
+		if (tracking == true)
+		{
+			std::swap(m_tracks[to->trackIndex[Slot(index)]],
+				other.m_tracks[from->trackIndex[slot]]);
+		}
+	}
+	other.Clear();
+}
+
+unsigned int ParticleList::Insert(Species species,
+	const ThreeVector &position, const ThreeVector &momentum, double weight,
+	double time, bool tracking)
+{
+	// Grow by a chunk once the existing ones are full
+	if ((m_particleNumber >> particleChunkShift) == m_chunks.size())
+	{
+		m_chunks.push_back(ParticleArena::ThreadArena().Acquire());
+	}
+	unsigned int index = m_particleNumber;
+	ParticleChunk* chunk = Chunk(index);
+	unsigned int slot = Slot(index);
+	chunk->xMom[slot] = momentum[0];
+	chunk->yMom[slot] = momentum[1];
+	chunk->zMom[slot] = momentum[2];
+	chunk->weight[slot] = weight;
+	chunk->species[slot] = species;
+	chunk->isAlive[slot] = true;
+	chunk->fieldCached[slot] = false;
+	chunk->quantumCached[slot] = false;
+	if (tracking == true)
+	{
+		// Track histories are kept on clear so their memory is reused
+		if (m_trackNumber == m_tracks.size())
+		{
+			m_tracks.push_back(ParticleTrack());
+		}
+		chunk->trackIndex[slot] = m_trackNumber++;
 	} else
 	{
-		std::cerr << "Error: Particle list too small!\n";
-		std::cerr << "New particles will be forgotten\n";
+		chunk->trackIndex[slot] = -1;
+	}
+
+	// Ballistic photons are stored as at the start of the photon clock
+	ThreeVector start = position;
+	if (IsBallistic(index))
+	{
+		start = start - PhotonOffset(index);
+		time -= m_photonClock;
 	}
-}
\ No newline at end of file
+	chunk->xPos[slot] = start[0];
+	chunk->yPos[slot] = start[1];
+	chunk->zPos[slot] = start[2];
+	chunk->time[slot] = time;
+	m_particleNumber++;
+	return index;
+}
+
+void ParticleList::UpdateTrack(unsigned int index, const ThreeVector &position,
+	const ThreeVector &momentum)
+{
+	ParticleChunk* chunk = Chunk(index);
+	unsigned int slot = Slot(index);
+	chunk->xMom[slot] = momentum[0];
+	chunk->yMom[slot] = momentum[1];
+	chunk->zMom[slot] = momentum[2];
+	ThreeVector start = position;
+	if (IsBallistic(index))
+	{
+		start = start - PhotonOffset(index);
+	}
+	// Processes update the momentum in place, which keeps the fields
+	if (chunk->xPos[slot] != start[0] || chunk->yPos[slot] != start[1]
+		|| chunk->zPos[slot] != start[2])
+	{
+		chunk->fieldCached[slot] = false;
+	}
+	chunk->quantumCached[slot] = false;
+	chunk->xPos[slot] = start[0];
+	chunk->yPos[slot] = start[1];
+	chunk->zPos[slot] = start[2];
+	if (chunk->trackIndex[slot] >= 0)
+	{
+		ParticleTrack& track = m_tracks[chunk->trackIndex[slot]];
+		track.position.push_back(position);
+		track.momentum.push_back(momentum);
+		track.time.push_back(chunk->time[slot]);
+		track.gamma.push_back(GetGamma(index));
+	}
+}
+
+void ParticleList::SetField(unsigned int index, const ThreeVector &eField,
+	const ThreeVector &bField)
+{
+	ParticleChunk* chunk = Chunk(index);
+	unsigned int slot = Slot(index);
+	chunk->xE[slot] = eField[0];
+	chunk->yE[slot] = eField[1];
+	chunk->zE[slot] = eField[2];
+	chunk->xB[slot] = bField[0];
+	chunk->yB[slot] = bField[1];
+	chunk->zB[slot] = bField[2];
+	chunk->fieldCached[slot] = !IsBallistic(index);
+}
+
+void ParticleList::InitOpticalDepth(unsigned int index)
+{
+	Chunk(index)->opticalDepth[Slot(index)] = MCTools::RandExponential(1.0);
+}
+
+const std::string& ParticleList::GetSpeciesName(unsigned int index) const
+{
+	return speciesNames[static_cast<unsigned int>(GetSpecies(index))];
+}
+
+ParticleStaging::ParticleStaging(ParticleList* list, ParticleList* staging):
+m_prevList(stagedList), m_prevStaging(stagingList)
+{
+	stagedList = list;
+	stagingList = staging;
+}
+
+ParticleStaging::~ParticleStaging()
+{
+	stagedList = m_prevList;
+	stagingList = m_prevStaging;
+}
@@ -1,34 +1,352 @@
 #ifndef PARTICLELIST_HH
 #define PARTICLELIST_HH
 
-#include<vector>
+#include <vector>
 #include <string>
+#include <cmath>
 
-#include "Particle.hh"
 #include "ThreeVector.hh"
 
+// Particle species held in the list. Mass and charge are derived from this
+enum class Species : unsigned char
+{
+	Photon,
+	Electron,
+	Positron
+};
+
+// History of a tracked particle. Only stored for particles with tracking on
+struct ParticleTrack
+{
+	std::vector<ThreeVector> position;
+	std::vector<ThreeVector> momentum;
+	std::vector<double> time;
+	std::vector<double> gamma;
+};
+
+// Number of particles held in each chunk of a list, must be a power of two
+const unsigned int particleChunkShift = 8;
+const unsigned int particleChunkSize = 1u << particleChunkShift;
+const unsigned int particleChunkMask = particleChunkSize - 1;
+
+// Fixed size block of particle properties. Each property is held in its own
+// contiguous array so loops over a chunk touch only the data they need.
+struct ParticleChunk
+{
+	double xPos[particleChunkSize];
+	double yPos[particleChunkSize];
+	double zPos[particleChunkSize];
+	double xMom[particleChunkSize];
+	double yMom[particleChunkSize];
+	double zMom[particleChunkSize];
+	double weight[particleChunkSize];
+	double time[particleChunkSize];
+	double opticalDepth[particleChunkSize];
+	Species species[particleChunkSize];
+	unsigned char isAlive[particleChunkSize];
+	int trackIndex[particleChunkSize];	// index into the track list, -1 if not tracked
+	// Fields at the particle and its quantum parameter, cached between the
+	// pusher and the processes. Only meaningful while the flags are set
+	double xE[particleChunkSize];
+	double yE[particleChunkSize];
+	double zE[particleChunkSize];
+	double xB[particleChunkSize];
+	double yB[particleChunkSize];
+	double zB[particleChunkSize];
+	double quantumParameter[particleChunkSize];
+	unsigned char fieldCached[particleChunkSize];
+	unsigned char quantumCached[particleChunkSize];
+};
+
+/* Segmented structure-of-arrays store for all the particles in an event.
+   Particles are addressed by their index in the list and stored in fixed
+   size chunks that are taken from the thread's ParticleArena as the list
+   grows, so adding a particle never moves existing ones and the list is
+   never full. Clearing the list keeps its chunks so it can be reused for
+   the next event, destroying it returns them to the arena.
+
+   Untracked photons are ballistic: they are not moved step by step but
+   follow a straight line against a clock shared by the whole list, which
+   AdvancePhotons runs forward once per step. Their chunk entries hold the
+   position and time they would have had when the clock was zero, and the
+   accessors add the clock back, so the rest of the code sees them move. */
 class ParticleList
 {
 public:
-	/* Default constructor. The maximum number of particles is set 
-	   before to avoid appending to list */
-	ParticleList(std::string name, unsigned int maxParticles = 1e6);
-	
+	ParticleList(std::string name);
+
 	~ParticleList();
 
+	// Lists own their chunks so cannot be copied
+	ParticleList(const ParticleList&) = delete;
+	ParticleList& operator=(const ParticleList&) = delete;
+
 	std::string GetName() const {return m_name;}
 
+	void SetName(std::string name) {m_name = name;}
+
 	unsigned int GetNPart() const {return m_particleNumber;}
 
-	Particle* GetParticle(unsigned int index) {return m_particleList[index];}	
+	// Number of chunks currently allocated to the list
+	unsigned int GetNChunks() const {return m_chunks.size();}
+
+	// Removes all particles while keeping the allocated memory
+	void Clear();
+
+	// Adds a particle to the list and returns its index, its index in the
+	// staging list if the calling thread is staging for this list
+	unsigned int AddParticle(Species species, const ThreeVector &position,
+		const ThreeVector &momentum, double weight = 1, double time = 0,
+		bool tracking = false);
+
+	// Moves the particles of other, with their optical depths and tracks,
+	// to the end of this list and clears other
+	void Append(ParticleList& other);
+
+	// Moves all the ballistic photons forward in time by dt
+	void AdvancePhotons(double dt) {m_photonClock += dt;}
+
+	// Photon whose motion follows the photon clock, see above
+	bool IsBallistic(unsigned int index) const
+	{
+		const ParticleChunk* chunk = Chunk(index);
+		unsigned int slot = Slot(index);
+		return chunk->species[slot] == Species::Photon
+			&& chunk->trackIndex[slot] < 0;
+	}
+
+	// Particle update methods
+	void UpdateTrack(unsigned int index, const ThreeVector &position,
+		const ThreeVector &momentum);
+
+	void UpdateTime(unsigned int index, double dt)
+	{
+		ParticleChunk* chunk = Chunk(index);
+		unsigned int slot = Slot(index);
+		chunk->time[slot] += dt;
+		chunk->fieldCached[slot] = false;
+		chunk->quantumCached[slot] = false;
+	}
+
+	void UpdateOpticalDepth(unsigned int index, double dtau)
+	{
+		Chunk(index)->opticalDepth[Slot(index)] -= dtau;
+	}
+
+	void InitOpticalDepth(unsigned int index);
+
+	void Kill(unsigned int index) {Chunk(index)->isAlive[Slot(index)] = false;}
+
+	// Particle access methods
+	ThreeVector GetPosition(unsigned int index) const
+	{
+		const ParticleChunk* chunk = Chunk(index);
+		unsigned int slot = Slot(index);
+		ThreeVector position(chunk->xPos[slot], chunk->yPos[slot],
+			chunk->zPos[slot]);
+		if (IsBallistic(index))
+		{
+			position = position + PhotonOffset(index);
+		}
+		return position;
+	}
+
+	ThreeVector GetMomentum(unsigned int index) const
+	{
+		const ParticleChunk* chunk = Chunk(index);
+		unsigned int slot = Slot(index);
+		return ThreeVector(chunk->xMom[slot], chunk->yMom[slot],
+			chunk->zMom[slot]);
+	}
+
+	ThreeVector GetDirection(unsigned int index) const
+	{
+		return GetMomentum(index).Norm();
+	}
+
+	Species GetSpecies(unsigned int index) const
+	{
+		return Chunk(index)->species[Slot(index)];
+	}
+
+	const std::string& GetSpeciesName(unsigned int index) const;
+
+	double GetMass(unsigned int index) const
+	{
+		return GetSpecies(index) == Species::Photon ? 0.0 : 1.0;
+	}
+
+	double GetCharge(unsigned int index) const
+	{
+		Species species = GetSpecies(index);
+		return species == Species::Photon ? 0.0
+			: (species == Species::Electron ? -1.0 : 1.0);
+	}
+
+	double GetTime(unsigned int index) const
+	{
+		double time = Chunk(index)->time[Slot(index)];
+		return IsBallistic(index) ? time + m_photonClock : time;
+	}
+
+	double GetWeight(unsigned int index) const
+	{
+		return Chunk(index)->weight[Slot(index)];
+	}
 
-	// Adds a particle to the source. Not very fast for large arrays
-	void AddParticle(Particle *part);
+	double GetOpticalDepth(unsigned int index) const
+	{
+		return Chunk(index)->opticalDepth[Slot(index)];
+	}
+
+	bool IsAlive(unsigned int index) const
+	{
+		return Chunk(index)->isAlive[Slot(index)];
+	}
+
+	bool GetTracking(unsigned int index) const
+	{
+		return Chunk(index)->trackIndex[Slot(index)] >= 0;
+	}
+
+	double GetGamma(unsigned int index) const;
+
+	double GetBeta(unsigned int index) const;
+
+	double GetEnergy(unsigned int index) const;
+
+	/* The fields at a particle are evaluated by the pusher and again by every
+	   process, always at the same place and time, so they are cached with the
+	   particle. The cache is dropped when the particle moves or its time
+	   changes. The quantum parameter, eta for leptons and chi for photons,
+	   also depends on the momentum so is dropped on any track update.
+	   Ballistic photons move without being updated, so nothing is cached
+	   for them. */
+	bool HasField(unsigned int index) const
+	{
+		return Chunk(index)->fieldCached[Slot(index)];
+	}
+
+	void GetField(unsigned int index, ThreeVector &eField,
+		ThreeVector &bField) const
+	{
+		const ParticleChunk* chunk = Chunk(index);
+		unsigned int slot = Slot(index);
+		eField = ThreeVector(chunk->xE[slot], chunk->yE[slot], chunk->zE[slot]);
+		bField = ThreeVector(chunk->xB[slot], chunk->yB[slot], chunk->zB[slot]);
+	}
+
+	void SetField(unsigned int index, const ThreeVector &eField,
+		const ThreeVector &bField);
+
+	bool HasQuantumParameter(unsigned int index) const
+	{
+		return Chunk(index)->quantumCached[Slot(index)];
+	}
+
+	double GetQuantumParameter(unsigned int index) const
+	{
+		return Chunk(index)->quantumParameter[Slot(index)];
+	}
+
+	void SetQuantumParameter(unsigned int index, double value)
+	{
+		ParticleChunk* chunk = Chunk(index);
+		unsigned int slot = Slot(index);
+		chunk->quantumParameter[slot] = value;
+		chunk->quantumCached[slot] = !IsBallistic(index);
+	}
+
+	// Returns the history of a tracked particle
+	const ParticleTrack& GetTrack(unsigned int index) const
+	{
+		return m_tracks[Chunk(index)->trackIndex[Slot(index)]];
+	}
+
+private:
+	// Adds a particle without drawing its optical depth
+	unsigned int Insert(Species species, const ThreeVector &position,
+		const ThreeVector &momentum, double weight, double time,
+		bool tracking);
+
+	ParticleChunk* Chunk(unsigned int index)
+	{
+		return m_chunks[index >> particleChunkShift];
+	}
+
+	const ParticleChunk* Chunk(unsigned int index) const
+	{
+		return m_chunks[index >> particleChunkShift];
+	}
+
+	static unsigned int Slot(unsigned int index)
+	{
+		return index & particleChunkMask;
+	}
+
+	// Distance a ballistic photon has moved while the clock ran
+	ThreeVector PhotonOffset(unsigned int index) const
+	{
+		ThreeVector momentum = GetMomentum(index);
+		return (m_photonClock / momentum.Mag()) * momentum;
+	}
 
 private:
 	std::string m_name;
-	unsigned int m_maxParticles;	// The maximum number of particles the list can take
 	unsigned int m_particleNumber;	// The current number of particles in the list
-	std::vector<Particle*> m_particleList;	// the list containing all the particles
+	unsigned int m_trackNumber;		// The current number of tracked particles
+	double m_photonClock;			// Time the ballistic photons have moved
+
+	std::vector<ParticleChunk*> m_chunks;	// Chunks owned by the list
+	std::vector<ParticleTrack> m_tracks;	// Histories of tracked particles
+};
+
+/* While a staging scope is alive, particles the calling thread adds to the
+   list go to the staging list instead. Threads stepping parts of one event
+   each stage their secondaries, which are appended to the event in a fixed
+   order once they are done, so the list is never grown by two threads. */
+class ParticleStaging
+{
+public:
+	ParticleStaging(ParticleList* list, ParticleList* staging);
+
+	~ParticleStaging();
+
+	ParticleStaging(const ParticleStaging&) = delete;
+	ParticleStaging& operator=(const ParticleStaging&) = delete;
+
+private:
+	ParticleList* m_prevList;		// Scope this one is nested in
+	ParticleList* m_prevStaging;
 };
-#endif
\ No newline at end of file
+
+inline double ParticleList::GetGamma(unsigned int index) const
+{
+	const ParticleChunk* chunk = Chunk(index);
+	unsigned int slot = Slot(index);
+	double p2 = chunk->xMom[slot] * chunk->xMom[slot]
+		+ chunk->yMom[slot] * chunk->yMom[slot]
+		+ chunk->zMom[slot] * chunk->zMom[slot];
+	if (chunk->species[slot] == Species::Photon)
+	{
+		return std::sqrt(p2);
+	}
+	return std::sqrt(1.0 + p2);
+}
+
+inline double ParticleList::GetBeta(unsigned int index) const
+{
+	if (GetSpecies(index) == Species::Photon)
+	{
+		return 1.0;
+	}
+	double gamma = GetGamma(index);
+	return std::sqrt(1.0 - 1.0 / (gamma * gamma));
+}
+
+inline double ParticleList::GetEnergy(unsigned int index) const
+{
+	// Leptons have unit mass so energy and gamma coincide
+	return GetGamma(index);
+}
+#endif
@@ -1,8 +1,22 @@
 #include "SourceGenerator.hh"
 #include "MCTools.hh"
 #include "UnitsSystem.hh"
-#include "Photon.hh"
-#include "Lepton.hh"
+
+#ifdef USEOPENMP
+    #include <omp.h>
+#endif
+
+namespace
+{
+    unsigned int ThreadID()
+    {
+#ifdef USEOPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+}
 
 SourceGenerator::SourceGenerator(std::string type, std::string distro,
                                  unsigned int nPart, double energy1, 
@@ -10,81 +24,108 @@ SourceGenerator::SourceGenerator(std::string type, std::string distro,
                                  double deltaTau, double deltaDir,
                                  const ThreeVector &position,
                                  const ThreeVector &direction,
-                                 bool track):
-m_type(type), m_nPart(nPart), m_partCount(0), m_track(track)
+                                 bool track, unsigned int stream):
+m_type(type), m_nPart(nPart), m_energy1(energy1), m_energy2(energy2),
+m_deltaPos(deltaPos), m_deltaTau(deltaTau), m_deltaDir(deltaDir),
+m_track(track), m_stream(stream)
 {
     m_direction = direction.Norm();
     m_position  = position;
-    m_xPos = MCTools::SampleNorm(0, deltaPos, nPart);
-    m_yPos = MCTools::SampleNorm(0, deltaPos, nPart);
-    m_zPos = MCTools::SampleNorm(0, deltaTau, nPart);
-    m_thetaDir = MCTools::SampleNorm(0, deltaDir, nPart);
-    m_phiDir = MCTools::SampleUniform(0, 2.0 * UnitsSystem::pi, nPart);
-    if (distro == "gaussian" || distro == "Gaussian")
-    {
-        m_energy = MCTools::SampleNorm(energy1, energy2, nPart);
-    } else if(distro == "linear" || distro == "Linear")
-    {
-        m_energy = MCTools::SampleUniform(energy1, energy2, nPart);
-    } else
-    {
-        m_energy = MCTools::SampleUniform(energy1, energy2, nPart);
-    }
+    // Linear and unknown distributions are both sampled uniformly
+    m_gaussian = distro == "gaussian" || distro == "Gaussian";
     
     m_rotaion = m_direction.RotateToAxis(ThreeVector(0, 0, 1));
+#ifdef USEOPENMP
+    m_freeLists.resize(omp_get_max_threads());
+#else
+    m_freeLists.resize(1);
+#endif
 }
 
 SourceGenerator::~SourceGenerator()
 {
+    for (unsigned int i = 0; i < m_freeLists.size(); i++)
+    {
+        for (unsigned int j = 0; j < m_freeLists[i].size(); j++)
+        {
+            delete m_freeLists[i][j];
+        }
+    }
 }
 
-ParticleList* SourceGenerator::GenerateList()
+ParticleList* SourceGenerator::GenerateList(unsigned long eventID)
 {
-    if (m_partCount == m_nPart)
+    if (eventID >= m_nPart)
     {
         std::cerr << "Error: Particle source depleted." << std::endl;
         std::exit(1);
     }
-    ParticleList* list = new ParticleList(std::to_string(m_partCount));
+    ParticleList* list;
+    unsigned int tid = ThreadID();
+    if (tid < m_freeLists.size() && m_freeLists[tid].empty() == false)
+    {
+        list = m_freeLists[tid].back();
+        m_freeLists[tid].pop_back();
+        list->SetName(std::to_string(eventID));
+    } else
+    {
+        list = new ParticleList(std::to_string(eventID));
+    }
+
+    // The source streams are kept apart from the event and task streams,
+    // so the primary does not depend on what else the event draws
+    PhiloxEngine engine = MCTools::StreamEngine(eventID,
+        0x40000000u | m_stream);
+    double normal[5];   // x, y, z, theta, gaussian energy
+    double uniform[2];  // phi, uniform energy
+    engine.FillNorm(normal, 5);
+    engine.FillUniform(uniform, 2);
 
-    ThreeVector partPosition = ThreeVector(m_xPos[m_partCount],
-                                           m_yPos[m_partCount],
-                                           m_zPos[m_partCount]);
+    ThreeVector partPosition = ThreeVector(m_deltaPos * normal[0],
+                                           m_deltaPos * normal[1],
+                                           m_deltaTau * normal[2]);
     partPosition = m_rotaion * partPosition + m_position;
 
-    ThreeVector partDirection = ThreeVector(std::sin(m_thetaDir[m_partCount])
-                                          * std::cos(m_phiDir[m_partCount]),
-                                            std::sin(m_thetaDir[m_partCount])
-                                          * std::sin(m_phiDir[m_partCount]),
-                                            std::cos(m_thetaDir[m_partCount]));
+    double theta = m_deltaDir * normal[3];
+    double phi = 2.0 * UnitsSystem::pi * uniform[0];
+    ThreeVector partDirection = ThreeVector(std::sin(theta) * std::cos(phi),
+                                            std::sin(theta) * std::sin(phi),
+                                            std::cos(theta));
     partDirection = m_rotaion * partDirection;
 
+    double energy = m_gaussian ? m_energy1 + m_energy2 * normal[4]
+        : m_energy1 + (m_energy2 - m_energy1) * uniform[1];
+
     if (m_type == "Photon" || m_type == "photon")
     {
-        Photon* part = new Photon(m_energy[m_partCount], partPosition,
-            partDirection, 1, 0, m_track);
-        list->AddParticle(part);
+        list->AddParticle(Species::Photon, partPosition,
+            energy * partDirection.Norm(), 1, 0, m_track);
     } else if (m_type == "Electron" || m_type == "electron")
     {
-        Lepton* part = new Lepton(1.0, -1.0, m_energy[m_partCount],
-            partPosition, partDirection, 1, 0, m_track);
-        list->AddParticle(part);
+        list->AddParticle(Species::Electron, partPosition,
+            energy * partDirection.Norm(), 1, 0, m_track);
     } else if (m_type == "Positron" || m_type == "positron")
     {
-        Lepton* part = new Lepton(1.0, 1.0, m_energy[m_partCount],
-            partPosition, partDirection, 1, 0, m_track);
-        list->AddParticle(part);
+        list->AddParticle(Species::Positron, partPosition,
+            energy * partDirection.Norm(), 1, 0, m_track);
     } else
     {
         std::cerr << "Error: Unkown particle type: " << m_type << "\n";
         std::cerr << "Exiting!\n";
         exit(-1);
     }
-    m_partCount++;
     return list;
 }
 
 void SourceGenerator::FreeSources(ParticleList* source)
 {
-    delete source;
+    unsigned int tid = ThreadID();
+    if (tid < m_freeLists.size())
+    {
+        source->Clear();
+        m_freeLists[tid].push_back(source);
+    } else
+    {
+        delete source;
+    }
 }
\ No newline at end of file
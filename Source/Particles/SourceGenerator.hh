@@ -14,12 +14,17 @@ class SourceGenerator
                     double deltaTau, double deltaDir,
                     const ThreeVector &position,
                     const ThreeVector &direction,
-                    bool track = false);
+                    bool track = false, unsigned int stream = 0);
     
     ~SourceGenerator();
 
-    ParticleList* GenerateList();
+    /* Generates primary eventID. Nothing is sampled up front, each primary
+       is drawn from a random stream of its own set by the run seed, the
+       event and the source stream, so any thread or rank can generate any
+       range of events in any order and memory does not grow with nPart */
+    ParticleList* GenerateList(unsigned long eventID);
 
+    // Returns the list to the calling thread so its memory can be reused
     void FreeSources(ParticleList* source);
 
     unsigned int GetSourceNumber() const {return m_nPart;} 
@@ -30,14 +35,16 @@ private:
     unsigned int m_nPart;
     ThreeVector m_position;
     ThreeVector m_direction;
-    std::vector<double> m_xPos;
-    std::vector<double> m_yPos;
-    std::vector<double> m_zPos;
-    std::vector<double> m_thetaDir;
-    std::vector<double> m_phiDir;
-    std::vector<double> m_energy;
-    unsigned int m_partCount;
+    bool m_gaussian;        // Gaussian energies, uniform otherwise
+    double m_energy1;
+    double m_energy2;
+    double m_deltaPos;
+    double m_deltaTau;
+    double m_deltaDir;
     ThreeMatrix m_rotaion;
     bool m_track;
+    unsigned int m_stream;
+    // Cleared lists waiting to be reused, one pool per thread
+    std::vector<std::vector<ParticleList*>> m_freeLists;
 };
 #endif
\ No newline at end of file
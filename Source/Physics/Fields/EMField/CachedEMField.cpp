@@ -0,0 +1,278 @@
+#include <cmath>
+
+#include "CachedEMField.hh"
+
+CachedEMField::CachedEMField(EMField* field, double spacing, double timeStep,
+    unsigned int brickSize, double memoryBudget,
+    FieldInterpolation interpolation, unsigned int errorSample):
+m_field(field), m_spacing(spacing), m_timeStep(timeStep),
+m_brickSize(brickSize), m_interpolation(interpolation),
+m_errorSample(errorSample), m_hits(0), m_misses(0), m_evictions(0),
+m_points(0), m_errorCount(0), m_maxError(0), m_sumError2(0), m_maxField(0)
+{
+    // Cubic interpolation needs a node either side of the cell, so the
+    // bricks overlap by an extra node below and above in space
+    m_ghost = m_interpolation == FieldInterpolation::Cubic ? 1 : 0;
+    m_spaceNodes = m_brickSize + 1 + 2 * m_ghost;
+    m_timeNodes = m_brickSize + 1;
+
+    double brickBytes = 6.0 * sizeof(double) * m_timeNodes * m_spaceNodes
+        * m_spaceNodes * m_spaceNodes;
+    double maxBricks = memoryBudget * 1024.0 * 1024.0 / brickBytes;
+    m_shardBricks = maxBricks > nShards ? maxBricks / nShards : 1;
+}
+
+CachedEMField::~CachedEMField()
+{
+    delete m_field;
+}
+
+void CachedEMField::GetField(double time, const ThreeVector &position,
+    ThreeVector &eField, ThreeVector &bField) const
+{
+    GridPoint point = Locate(time, position[0], position[1], position[2]);
+    std::shared_ptr<const Brick> brick = FindBrick(point.key);
+    double field[6];
+    Interpolate(*brick, point, field);
+    if (m_errorSample > 0 && m_points++ % m_errorSample == 0)
+    {
+        SampleError(time, position[0], position[1], position[2], field);
+    }
+    eField = ThreeVector(field[0], field[1], field[2]);
+    bField = ThreeVector(field[3], field[4], field[5]);
+}
+
+void CachedEMField::GetFields(FieldBatch &batch) const
+{
+    // Neighbouring points are usually in the same brick, so the last one is
+    // kept without going through the shards
+    std::shared_ptr<const Brick> brick;
+    BrickKey lastKey = {0, 0, 0, 0};
+    unsigned long reused = 0;
+    unsigned long firstPoint = m_errorSample > 0 ? m_points.fetch_add(batch.size)
+        : 0;
+    for (unsigned int i = 0; i < batch.size; i++)
+    {
+        GridPoint point = Locate(batch.time[i], batch.xPos[i], batch.yPos[i],
+            batch.zPos[i]);
+        if (brick && point.key == lastKey)
+        {
+            reused++;
+        } else
+        {
+            brick = FindBrick(point.key);
+            lastKey = point.key;
+        }
+        double field[6];
+        Interpolate(*brick, point, field);
+        if (m_errorSample > 0 && (firstPoint + i) % m_errorSample == 0)
+        {
+            SampleError(batch.time[i], batch.xPos[i], batch.yPos[i],
+                batch.zPos[i], field);
+        }
+        batch.xE[i] = field[0];
+        batch.yE[i] = field[1];
+        batch.zE[i] = field[2];
+        batch.xB[i] = field[3];
+        batch.yB[i] = field[4];
+        batch.zB[i] = field[5];
+    }
+    m_hits += reused;
+}
+
+void CachedEMField::PrintStats(std::ostream& out) const
+{
+    unsigned long hits = m_hits, misses = m_misses;
+    double hitRate = hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0;
+    out << "Field cache: hit rate = " << hitRate << "%, bricks filled = "
+        << misses << ", evicted = " << m_evictions << "\n";
+
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    if (m_errorCount > 0)
+    {
+        out << "Field cache interpolation error over " << m_errorCount
+            << " samples: max = " << m_maxError / m_maxField << ", rms = "
+            << std::sqrt(m_sumError2 / m_errorCount) / m_maxField
+            << " of the largest sampled field\n";
+    }
+}
+
+CachedEMField::GridPoint CachedEMField::Locate(double time, double x,
+    double y, double z) const
+{
+    GridPoint point;
+    double coord[4] = {time / m_timeStep, x / m_spacing, y / m_spacing,
+        z / m_spacing};
+    int brick[4];
+    int size = m_brickSize;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        double cell = std::floor(coord[i]);
+        int index = static_cast<int>(cell);
+        brick[i] = index >= 0 ? index / size : -((-index - 1) / size) - 1;
+        point.cell[i] = index - brick[i] * size;
+        point.frac[i] = coord[i] - cell;
+    }
+    point.key.t = brick[0];
+    point.key.x = brick[1];
+    point.key.y = brick[2];
+    point.key.z = brick[3];
+    return point;
+}
+
+std::shared_ptr<const CachedEMField::Brick> CachedEMField::FindBrick(
+    const BrickKey& key) const
+{
+    Shard& shard = m_shards[BrickKeyHash()(key) % nShards];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.bricks.find(key);
+        if (found != shard.bricks.end())
+        {
+            shard.recent.splice(shard.recent.begin(), shard.recent,
+                found->second.recent);
+            m_hits++;
+            return found->second.brick;
+        }
+    }
+
+    // Filled without the lock so other threads can carry on. If another
+    // thread fills the same brick first its copy is used
+    std::shared_ptr<const Brick> brick = FillBrick(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.bricks.find(key);
+    if (found != shard.bricks.end())
+    {
+        m_hits++;
+        return found->second.brick;
+    }
+    m_misses++;
+    shard.recent.push_front(key);
+    BrickEntry entry = {brick, shard.recent.begin()};
+    shard.bricks[key] = entry;
+    while (shard.bricks.size() > m_shardBricks)
+    {
+        // Threads still using an evicted brick keep it alive
+        shard.bricks.erase(shard.recent.back());
+        shard.recent.pop_back();
+        m_evictions++;
+    }
+    return brick;
+}
+
+std::shared_ptr<const CachedEMField::Brick> CachedEMField::FillBrick(
+    const BrickKey& key) const
+{
+    unsigned int nSpace = m_spaceNodes;
+    unsigned int nNodes = m_timeNodes * nSpace * nSpace * nSpace;
+    std::shared_ptr<Brick> brick = std::make_shared<Brick>(6 * nNodes);
+    double* data = brick->data();
+
+    // Node i of a brick along a space axis is at cell i - m_ghost
+    int size = m_brickSize;
+    FieldBatch batch;
+    for (unsigned int start = 0; start < nNodes; start += FieldBatch::capacity)
+    {
+        batch.size = 0;
+        for (unsigned int node = start; node < nNodes
+            && batch.size < FieldBatch::capacity; node++)
+        {
+            int iz = node % nSpace;
+            int iy = (node / nSpace) % nSpace;
+            int ix = (node / (nSpace * nSpace)) % nSpace;
+            int it = node / (nSpace * nSpace * nSpace);
+            batch.SetPoint(batch.size, (key.t * size + it) * m_timeStep,
+                ThreeVector((key.x * size + ix - m_ghost) * m_spacing,
+                    (key.y * size + iy - m_ghost) * m_spacing,
+                    (key.z * size + iz - m_ghost) * m_spacing));
+            batch.size++;
+        }
+        m_field->GetFields(batch);
+        for (unsigned int i = 0; i < batch.size; i++)
+        {
+            double* node = data + 6 * (start + i);
+            node[0] = batch.xE[i];
+            node[1] = batch.yE[i];
+            node[2] = batch.zE[i];
+            node[3] = batch.xB[i];
+            node[4] = batch.yB[i];
+            node[5] = batch.zB[i];
+        }
+    }
+    return brick;
+}
+
+void CachedEMField::Interpolate(const Brick& brick, const GridPoint& point,
+    double* field) const
+{
+    // Weights of the nodes along each axis. Linear uses the two nodes of the
+    // cell, cubic the four nodes from the one before the cell
+    unsigned int nWeights = m_interpolation == FieldInterpolation::Cubic ? 4 : 2;
+    double weight[4][4];
+    weight[0][0] = 1.0 - point.frac[0];
+    weight[0][1] = point.frac[0];
+    for (unsigned int axis = 1; axis < 4; axis++)
+    {
+        double f = point.frac[axis];
+        if (nWeights == 2)
+        {
+            weight[axis][0] = 1.0 - f;
+            weight[axis][1] = f;
+        } else
+        {
+            double f2 = f * f, f3 = f2 * f;
+            weight[axis][0] = 0.5 * (-f3 + 2.0 * f2 - f);
+            weight[axis][1] = 0.5 * (3.0 * f3 - 5.0 * f2 + 2.0);
+            weight[axis][2] = 0.5 * (-3.0 * f3 + 4.0 * f2 + f);
+            weight[axis][3] = 0.5 * (f3 - f2);
+        }
+    }
+
+    for (unsigned int c = 0; c < 6; c++) field[c] = 0;
+    unsigned int nSpace = m_spaceNodes;
+    const double* data = brick.data();
+    for (unsigned int it = 0; it < 2; it++)
+    {
+        unsigned int tNode = point.cell[0] + it;
+        for (unsigned int ix = 0; ix < nWeights; ix++)
+        {
+            unsigned int xNode = tNode * nSpace + point.cell[1] + ix;
+            double wx = weight[0][it] * weight[1][ix];
+            for (unsigned int iy = 0; iy < nWeights; iy++)
+            {
+                unsigned int yNode = xNode * nSpace + point.cell[2] + iy;
+                const double* row = data + 6 * (yNode * nSpace + point.cell[3]);
+                double wy = wx * weight[2][iy];
+                for (unsigned int iz = 0; iz < nWeights; iz++)
+                {
+                    double w = wy * weight[3][iz];
+                    for (unsigned int c = 0; c < 6; c++)
+                    {
+                        field[c] += w * row[6 * iz + c];
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CachedEMField::SampleError(double time, double x, double y, double z,
+    const double* field) const
+{
+    ThreeVector eField, bField;
+    m_field->GetField(time, ThreeVector(x, y, z), eField, bField);
+    double exact[6] = {eField[0], eField[1], eField[2], bField[0], bField[1],
+        bField[2]};
+    double error2 = 0, field2 = 0;
+    for (unsigned int c = 0; c < 6; c++)
+    {
+        error2 += (field[c] - exact[c]) * (field[c] - exact[c]);
+        field2 += exact[c] * exact[c];
+    }
+
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    m_errorCount++;
+    m_sumError2 += error2;
+    m_maxError = std::fmax(m_maxError, std::sqrt(error2));
+    m_maxField = std::fmax(m_maxField, std::sqrt(field2));
+}
@@ -0,0 +1,167 @@
+#ifndef CACHEDEMFIELD_HH
+#define CACHEDEMFIELD_HH
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "EMField.hh"
+
+// Interpolation used by CachedEMField. Linear is multilinear in space and
+// time, cubic is Catmull-Rom in space and linear in time
+enum class FieldInterpolation
+{
+    Linear,
+    Cubic
+};
+
+/* Decorator that interpolates another field from a space-time grid instead
+   of evaluating it at every point. The grid is split into bricks of
+   brickSize cells along each axis, and a brick is filled from the wrapped
+   field the first time a point falls inside it. Bricks are shared by all
+   threads through a set of independently locked shards, and once the memory
+   budget is used the least recently used bricks are dropped. Every
+   errorSample-th point is also evaluated directly to measure the
+   interpolation error. The cache takes ownership of the wrapped field. */
+class CachedEMField: public EMField
+{
+public:
+    CachedEMField(EMField* field, double spacing, double timeStep,
+        unsigned int brickSize = 8, double memoryBudget = 1024,
+        FieldInterpolation interpolation = FieldInterpolation::Linear,
+        unsigned int errorSample = 1000);
+
+    ~CachedEMField();
+
+    void GetField(double time, const ThreeVector &position,
+        ThreeVector &eField, ThreeVector &bField) const override;
+
+    void GetFields(FieldBatch &batch) const override;
+
+    bool InSupport(double time, const ThreeVector &position) const override
+    {
+        return m_field->InSupport(time, position);
+    }
+
+    double EntryTime(double time, const ThreeVector &position,
+        const ThreeVector &velocity) const override
+    {
+        return m_field->EntryTime(time, position, velocity);
+    }
+
+    // Linear interpolation stays within the values at the nodes, cubic can
+    // overshoot them so has no bound
+    double MaxStrength() const override
+    {
+        return m_interpolation == FieldInterpolation::Linear
+            ? m_field->MaxStrength() : EMField::MaxStrength();
+    }
+
+    // Hit rate, evictions and the sampled interpolation error
+    void PrintStats(std::ostream& out) const override;
+
+    unsigned long GetHits() const {return m_hits;}
+
+    unsigned long GetMisses() const {return m_misses;}
+
+    unsigned long GetEvictions() const {return m_evictions;}
+
+private:
+    // Brick coordinates, in bricks along each axis
+    struct BrickKey
+    {
+        int t, x, y, z;
+
+        bool operator==(const BrickKey& other) const
+        {
+            return t == other.t && x == other.x && y == other.y
+                && z == other.z;
+        }
+    };
+
+    struct BrickKeyHash
+    {
+        std::size_t operator()(const BrickKey& key) const
+        {
+            std::size_t hash = static_cast<unsigned int>(key.t);
+            hash = hash * 1000003u ^ static_cast<unsigned int>(key.x);
+            hash = hash * 1000003u ^ static_cast<unsigned int>(key.y);
+            hash = hash * 1000003u ^ static_cast<unsigned int>(key.z);
+            return hash;
+        }
+    };
+
+    // Field at the nodes of a brick, the six components of each node are
+    // stored together
+    typedef std::vector<double> Brick;
+
+    typedef std::list<BrickKey> LRUList;
+
+    struct BrickEntry
+    {
+        std::shared_ptr<const Brick> brick;
+        LRUList::iterator recent;
+    };
+
+    // Part of the cache with its own lock, bricks are spread over the shards
+    // by their hash
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<BrickKey, BrickEntry, BrickKeyHash> bricks;
+        LRUList recent;     // most recently used at the front
+    };
+
+    // Position of a point in the grid
+    struct GridPoint
+    {
+        BrickKey key;
+        int cell[4];        // cell of the point within its brick, t x y z
+        double frac[4];     // position of the point within its cell
+    };
+
+    GridPoint Locate(double time, double x, double y, double z) const;
+
+    // Returns the brick, filling it if it is not cached
+    std::shared_ptr<const Brick> FindBrick(const BrickKey& key) const;
+
+    std::shared_ptr<const Brick> FillBrick(const BrickKey& key) const;
+
+    void Interpolate(const Brick& brick, const GridPoint& point,
+        double* field) const;
+
+    // Compares with the wrapped field at a sample of the points
+    void SampleError(double time, double x, double y, double z,
+        const double* field) const;
+
+private:
+    static const unsigned int nShards = 16;
+
+    EMField* m_field;           // Field being interpolated
+    double m_spacing;           // Grid spacing in space
+    double m_timeStep;          // Grid spacing in time
+    unsigned int m_brickSize;   // Cells along each axis of a brick
+    FieldInterpolation m_interpolation;
+    unsigned int m_errorSample; // Points between error samples, 0 for none
+    int m_ghost;                // Extra nodes below a brick in space
+    unsigned int m_spaceNodes;  // Nodes along each space axis of a brick
+    unsigned int m_timeNodes;   // Nodes along the time axis of a brick
+    unsigned int m_shardBricks; // Bricks held by each shard
+
+    mutable Shard m_shards[nShards];
+    mutable std::atomic<unsigned long> m_hits;
+    mutable std::atomic<unsigned long> m_misses;
+    mutable std::atomic<unsigned long> m_evictions;
+    mutable std::atomic<unsigned long> m_points;
+
+    mutable std::mutex m_errorMutex;
+    mutable unsigned long m_errorCount;
+    mutable double m_maxError;
+    mutable double m_sumError2;
+    mutable double m_maxField;
+};
+#endif
@@ -0,0 +1,114 @@
+#include <cmath>
+#include <limits>
+
+#include "CompositeEMField.hh"
+
+CompositeEMField::CompositeEMField()
+{
+}
+
+CompositeEMField::~CompositeEMField()
+{
+	for (unsigned int i = 0; i < m_fields.size(); i++)
+	{
+		delete m_fields[i];
+	}
+}
+
+void CompositeEMField::AddField(EMField* field)
+{
+	m_fields.push_back(field);
+}
+
+void CompositeEMField::GetField(double time, const ThreeVector &position,
+	ThreeVector &eField, ThreeVector &bField) const
+{
+	eField = ThreeVector(0, 0, 0);
+	bField = ThreeVector(0, 0, 0);
+	ThreeVector partE, partB;
+	for (unsigned int i = 0; i < m_fields.size(); i++)
+	{
+		if (!m_fields[i]->InSupport(time, position)) continue;
+		m_fields[i]->GetField(time, position, partE, partB);
+		eField = eField + partE;
+		bField = bField + partB;
+	}
+}
+
+void CompositeEMField::GetFields(FieldBatch &batch) const
+{
+	for (unsigned int i = 0; i < batch.size; i++)
+	{
+		batch.xE[i] = batch.yE[i] = batch.zE[i] = 0;
+		batch.xB[i] = batch.yB[i] = batch.zB[i] = 0;
+	}
+
+	// Each field is evaluated in a batch of just the points in its support,
+	// then added back to the points it came from
+	FieldBatch part;
+	unsigned int points[FieldBatch::capacity];
+	for (unsigned int f = 0; f < m_fields.size(); f++)
+	{
+		part.size = 0;
+		for (unsigned int i = 0; i < batch.size; i++)
+		{
+			ThreeVector position(batch.xPos[i], batch.yPos[i], batch.zPos[i]);
+			if (!m_fields[f]->InSupport(batch.time[i], position)) continue;
+			points[part.size] = i;
+			part.SetPoint(part.size, batch.time[i], position);
+			part.size++;
+		}
+		if (part.size == 0) continue;
+
+		m_fields[f]->GetFields(part);
+		for (unsigned int j = 0; j < part.size; j++)
+		{
+			unsigned int i = points[j];
+			batch.xE[i] += part.xE[j];
+			batch.yE[i] += part.yE[j];
+			batch.zE[i] += part.zE[j];
+			batch.xB[i] += part.xB[j];
+			batch.yB[i] += part.yB[j];
+			batch.zB[i] += part.zB[j];
+		}
+	}
+}
+
+bool CompositeEMField::InSupport(double time, const ThreeVector &position) const
+{
+	for (unsigned int i = 0; i < m_fields.size(); i++)
+	{
+		if (m_fields[i]->InSupport(time, position)) return true;
+	}
+	return false;
+}
+
+double CompositeEMField::EntryTime(double time, const ThreeVector &position,
+	const ThreeVector &velocity) const
+{
+	double entry = std::numeric_limits<double>::infinity();
+	for (unsigned int i = 0; i < m_fields.size(); i++)
+	{
+		entry = std::fmin(entry, m_fields[i]->EntryTime(time, position,
+			velocity));
+	}
+	return entry;
+}
+
+double CompositeEMField::MaxStrength() const
+{
+	double strength = 0;
+	for (unsigned int i = 0; i < m_fields.size(); i++)
+	{
+		strength += m_fields[i]->MaxStrength();
+	}
+	return strength;
+}
+
+void CompositeEMField::PrintStats(std::ostream& out) const
+{
+	for (unsigned int i = 0; i < m_fields.size(); i++)
+	{
+		m_fields[i]->PrintStats(out);
+	}
+}
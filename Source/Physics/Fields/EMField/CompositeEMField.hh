@@ -0,0 +1,41 @@
+#ifndef COMPOSITEEMFIELD_HH
+#define COMPOSITEEMFIELD_HH
+
+#include <vector>
+
+#include "EMField.hh"
+
+// Sum of any number of fields, e.g. colliding pulses or a laser and a static
+// magnet. At each point only the fields whose support contains it are
+// evaluated. The composite takes ownership of the fields added to it
+class CompositeEMField: public EMField
+{
+public:
+	CompositeEMField();
+
+	~CompositeEMField();
+
+	void AddField(EMField* field);
+
+	unsigned int GetNFields() const {return m_fields.size();}
+
+	void GetField(double time, const ThreeVector &position,
+		ThreeVector &eField, ThreeVector &bField) const override;
+
+	void GetFields(FieldBatch &batch) const override;
+
+	bool InSupport(double time, const ThreeVector &position) const override;
+
+	// The earliest entry into any of the fields
+	double EntryTime(double time, const ThreeVector &position,
+		const ThreeVector &velocity) const override;
+
+	// The sum of the bounds of the fields
+	double MaxStrength() const override;
+
+	void PrintStats(std::ostream& out) const override;
+
+private:
+	std::vector<EMField*> m_fields;
+};
+#endif
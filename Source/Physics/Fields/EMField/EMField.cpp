@@ -0,0 +1,46 @@
+#include "EMField.hh"
+
+void EMField::GetFields(FieldBatch &batch) const
+{
+	ThreeVector eField, bField;
+	for (unsigned int i = 0; i < batch.size; i++)
+	{
+		GetField(batch.time[i], ThreeVector(batch.xPos[i], batch.yPos[i],
+			batch.zPos[i]), eField, bField);
+		batch.xE[i] = eField[0];
+		batch.yE[i] = eField[1];
+		batch.zE[i] = eField[2];
+		batch.xB[i] = bField[0];
+		batch.yB[i] = bField[1];
+		batch.zB[i] = bField[2];
+	}
+}
+
+void EMField::FillParticleFields(ParticleList* partList,
+	const unsigned int* indices, unsigned int n) const
+{
+	FieldBatch batch;
+	unsigned int missing[FieldBatch::capacity];
+	unsigned int i = 0;
+	while (i < n)
+	{
+		batch.size = 0;
+		for (; i < n && batch.size < FieldBatch::capacity; i++)
+		{
+			if (partList->HasField(indices[i])) continue;
+			missing[batch.size] = indices[i];
+			batch.SetPoint(batch.size, partList->GetTime(indices[i]),
+				partList->GetPosition(indices[i]));
+			batch.size++;
+		}
+		if (batch.size == 0) continue;
+
+		GetFields(batch);
+		ThreeVector eField, bField;
+		for (unsigned int j = 0; j < batch.size; j++)
+		{
+			batch.GetField(j, eField, bField);
+			partList->SetField(missing[j], eField, bField);
+		}
+	}
+}
@@ -1,7 +1,43 @@
 #ifndef EMFIELD_HH
 #define EMFIELD_HH
 
+#include <limits>
+#include <ostream>
+
 #include "ThreeVector.hh"
+#include "ParticleList.hh"
+
+// Points at which fields are wanted and the fields there, one array per
+// component so a field can vectorise its evaluation over the points
+struct FieldBatch
+{
+	static const unsigned int capacity = particleChunkSize;
+	unsigned int size;
+	double time[capacity];
+	double xPos[capacity];
+	double yPos[capacity];
+	double zPos[capacity];
+	double xE[capacity];
+	double yE[capacity];
+	double zE[capacity];
+	double xB[capacity];
+	double yB[capacity];
+	double zB[capacity];
+
+	void SetPoint(unsigned int i, double t, const ThreeVector &position)
+	{
+		time[i] = t;
+		xPos[i] = position[0];
+		yPos[i] = position[1];
+		zPos[i] = position[2];
+	}
+
+	void GetField(unsigned int i, ThreeVector &eField, ThreeVector &bField) const
+	{
+		eField = ThreeVector(xE[i], yE[i], zE[i]);
+		bField = ThreeVector(xB[i], yB[i], zB[i]);
+	}
+};
 
 class EMField
 {
@@ -12,6 +48,60 @@ public:
 
 	virtual void GetField(double time, const ThreeVector &position,
 						  ThreeVector &eField, ThreeVector &bField) const = 0;
+
+	// Fields at every point of the batch, by default one point at a time
+	virtual void GetFields(FieldBatch &batch) const;
+
+	// False where the field is negligible, so composite fields can skip it.
+	// By default a field is everywhere
+	virtual bool InSupport(double time, const ThreeVector &position) const
+	{
+		return true;
+	}
+
+	/* Earliest time from time at which a particle moving in a straight line
+	   from position with the given velocity can be in the support. It may be
+	   early but is never late, and is infinite if the particle never enters.
+	   By default the particle is always in the support */
+	virtual double EntryTime(double time, const ThreeVector &position,
+		const ThreeVector &velocity) const
+	{
+		return time;
+	}
+
+	// Upper bound on |E| + |B| anywhere at any time, infinite if the field
+	// has none
+	virtual double MaxStrength() const
+	{
+		return std::numeric_limits<double>::infinity();
+	}
+
+	// Statistics gathered during the run, by default none
+	virtual void PrintStats(std::ostream& out) const {}
+
+	// Fields at a particle, evaluated only if the particle has none cached
+	void GetParticleField(ParticleList* partList, unsigned int index,
+		ThreeVector &eField, ThreeVector &bField) const
+	{
+		if (partList->HasField(index))
+		{
+			partList->GetField(index, eField, bField);
+			return;
+		}
+		GetField(partList->GetTime(index), partList->GetPosition(index),
+			eField, bField);
+		partList->SetField(index, eField, bField);
+	}
+
+	// Caches the fields of the listed particles that have none, evaluated
+	// in batches
+	void FillParticleFields(ParticleList* partList, const unsigned int* indices,
+		unsigned int n) const;
+
+protected:
+	// Pulses are taken to be zero where their Gaussian envelope is below
+	// exp(-envelopeCutoff), about 1e-17 of the peak
+	static constexpr double envelopeCutoff = 40.0;
 };
 
-#endif
\ No newline at end of file
+#endif
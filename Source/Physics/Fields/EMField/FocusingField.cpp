@@ -1,6 +1,10 @@
+#include <cmath>
+#include <limits>
+
 #include "FocusingField.hh"
 
 #include "UnitsSystem.hh"
+#include "VecMath.hh"
 
 FocusingField::FocusingField(double maxE,  double waveLength, double tau,
     double waist, double polAngle, const ThreeVector& startPos,
@@ -17,73 +21,157 @@ m_polAngle(polAngle)
     m_waveNum = 2.0 * UnitsSystem::pi / m_waveLength;
     m_rayleigh = m_waveNum * m_waist * m_waist / 2.0;
     m_eps = m_waist / m_rayleigh;
+    m_invTau2 = 1.0 / (m_tau * m_tau);
+    m_cosPol = std::cos(m_polAngle);
+    m_sinPol = std::sin(m_polAngle);
+    m_alongZ = (m_waveVec - ThreeVector(0,0,1)).Mag2() < 1e-30;
 }
 
 FocusingField::~FocusingField()
 {
 }
 
+template <bool rotate>
+void FocusingField::Evaluate(unsigned int n, const double* time,
+    const double* xPos, const double* yPos, const double* zPos, double* xE,
+    double* yE, double* zE, double* xB, double* yB, double* zB) const
+{
+    #pragma omp simd
+    for (unsigned int point = 0; point < n; point++)
+    {
+        double x = xPos[point], y = yPos[point], z = zPos[point];
+        double xp = x, yp = y, zp = z;
+        if (rotate)
+        {
+            xp = m_rotaion[0][0] * x + m_rotaion[0][1] * y + m_rotaion[0][2] * z;
+            yp = m_rotaion[1][0] * x + m_rotaion[1][1] * y + m_rotaion[1][2] * z;
+            zp = m_rotaion[2][0] * x + m_rotaion[2][1] * y + m_rotaion[2][2] * z;
+        }
+        double xe = xp / m_waist;
+        double ye = yp / m_waist;
+        double ze = zp / m_rayleigh;
+        double r2  = xp * xp + yp * yp;
+        double rho2 = r2 / (m_waist *  m_waist);
+        double rho4 = rho2 * rho2;
+        double curvature = zp + m_rayleigh * m_rayleigh / (zp + 1e-99);
+        double phi = m_waveNum * (zp - r2 / (2.0 * curvature));
+        double w2 = m_waist * m_waist * (1 + ze * ze);
+        double tRel = time[point] - m_t0 - zp;
+        double E_0 = m_maxE * VecMath::Exp(- r2 / w2 - tRel * tRel * m_invTau2);
+        E_0 = E_0 < 1.0e-15 ? 0.0 : E_0;
+
+        /* C[i] + i S[i] = (w0/w)^(i+1) exp(i(phi + (i+1) phi_G)) with
+           phi_G = atan(ze). As (w0/w) exp(i phi_G) = 1 / (1 - i ze) the terms
+           follow from exp(i phi) by repeated complex products, so one sincos
+           replaces the powers, the arctan and the twelve sines and cosines */
+        double uRe = 1.0 / (1.0 + ze * ze);
+        double uIm = ze * uRe;
+        double re, im, S[7], C[5];
+        VecMath::SinCos(phi, im, re);
+        for (int i = 0; i < 7; ++i)
+        {
+            double next = re * uRe - im * uIm;
+            im = re * uIm + im * uRe;
+            re = next;
+            S[i] = im;
+            if (i < 5) C[i] = re;
+        }
+
+        double eps = m_eps, eps2 = m_eps * m_eps;
+        double E[3], B[3];
+        E[0] = E_0 * (S[0] + eps2 * (xe * xe * S[2] - rho4 * S[3] / 4.0)
+            + eps2 * eps2 * (S[2] / 8.0 - rho2 * S[3] / 4.0
+                - rho2 * (rho2 - 16 * xe * xe) * S[4] / 16.0
+                - rho4 * (rho2 + 2 * xe * xe) * S[5] / 8.0
+                + rho4 * rho4 * S[6] / 32.0));
+        E[1] = E_0 * xe * ye * (eps2 * S[2] + eps2 * eps2
+            * (rho2 * S[4] - rho4 * S[5] / 4.0));
+        E[2] = E_0 * xe * (eps * C[1] + eps2 * eps * (-C[2] / 2.0
+            + rho2 * C[3] - rho4 * C[4] / 4.0));
+        B[0] = 0;
+        B[1] = E_0 * (S[0] + eps2 * (rho2 * S[2] / 2.0 - rho4 * S[3] / 4.0)
+            + eps2 * eps2 * (- S[2] / 8.0 + rho2 * S[3] / 4.0
+                + 5.0 * rho4 * S[4] / 16.0 - rho4 * rho2 * S[5] / 4.0
+                + rho4 * rho4 * S[6] / 32.0));
+        B[2] = E_0 * ye * (eps * C[1] + eps2 * eps * (C[2] / 2.0
+            + rho2 * C[3] / 2.0 - rho4 * C[4] / 4.0));
+
+        // Polarisation, applied in place
+        E[0] = E[0] * m_cosPol - E[1] * m_sinPol;
+        E[1] = E[0] * m_sinPol + E[1] * m_cosPol;
+        B[0] = B[0] * m_cosPol - B[1] * m_sinPol;
+        B[1] = B[0] * m_sinPol + B[1] * m_cosPol;
+
+        if (rotate)
+        {
+            ThreeVector eField = m_rotationInv * ThreeVector(E[0], E[1], E[2]);
+            ThreeVector bField = m_rotationInv * ThreeVector(B[0], B[1], B[2]);
+            for (int i = 0; i < 3; i++)
+            {
+                E[i] = eField[i];
+                B[i] = bField[i];
+            }
+        }
+        xE[point] = E[0];
+        yE[point] = E[1];
+        zE[point] = E[2];
+        xB[point] = B[0];
+        yB[point] = B[1];
+        zB[point] = B[2];
+    }
+}
+
 void FocusingField::GetField(double time, const ThreeVector &position,
     ThreeVector &eField, ThreeVector &bField) const
 {
-    ThreeVector position_p = m_rotaion * position;
-    double xe = position_p[0] / m_waist;
-    double ye = position_p[1] / m_waist;
-    double ze = position_p[2] / m_rayleigh;
-    double r2  = position_p[0] * position_p[0] + position_p[1] * position_p[1];
-    double rho2 = r2 / (m_waist *  m_waist);
-    double curvature = position_p[2] + m_rayleigh * m_rayleigh
-        / (position_p[2] + 1e-99);
-    double phi_G = std::atan(ze);
-    double phi = m_waveNum * (position_p[2] - r2 / (2.0 * curvature));
-    double w = m_waist * std::sqrt(1 + ze * ze);
-    double E_0 = m_maxE * std::exp(- r2 / (w * w) - (time - m_t0 - position_p[2])
-            * (time - m_t0 - position_p[2]) / (m_tau * m_tau));
-
-    if (E_0 < 1.0e-15)
+    double x = position[0], y = position[1], z = position[2];
+    if (m_alongZ)
     {
-          eField = ThreeVector(0, 0, 0);
-          bField = ThreeVector(0, 0, 0);
-          return;
+        Evaluate<false>(1, &time, &x, &y, &z, &eField[0], &eField[1],
+            &eField[2], &bField[0], &bField[1], &bField[2]);
+    } else
+    {
+        Evaluate<true>(1, &time, &x, &y, &z, &eField[0], &eField[1],
+            &eField[2], &bField[0], &bField[1], &bField[2]);
     }
+}
 
-    // Calculate the S and C componnetest
-    double S[7];
-    for (int i = 0; i < 7; ++i)
+void FocusingField::GetFields(FieldBatch &batch) const
+{
+    if (m_alongZ)
     {
-        S[i] = std::pow(m_waist / w, i + 1) * std::sin(phi + (i + 1) * phi_G);
-    }
-    double C[5];
-    for (int i = 0; i < 5; ++i)
+        Evaluate<false>(batch.size, batch.time, batch.xPos, batch.yPos,
+            batch.zPos, batch.xE, batch.yE, batch.zE, batch.xB, batch.yB,
+            batch.zB);
+    } else
     {
-        C[i] = std::pow(m_waist / w, i + 1) * std::cos(phi + (i + 1) * phi_G);
+        Evaluate<true>(batch.size, batch.time, batch.xPos, batch.yPos,
+            batch.zPos, batch.xE, batch.yE, batch.zE, batch.xB, batch.yB,
+            batch.zB);
     }
+}
 
-    eField[0] = E_0 * (S[0] + m_eps * m_eps * (xe * xe * S[2]
-        - rho2 * rho2 * S[3] / 4.0) + m_eps * m_eps * m_eps * m_eps
-        * (S[2] / 8.0 - rho2 * S[3] / 4.0
-            - rho2 * (rho2 - 16 * xe * xe) * S[4] / 16.0
-            - rho2 * rho2 * (rho2 + 2 * xe * xe) * S[5] / 8.0
-            + rho2 * rho2 * rho2 * rho2 * S[6] / 32.0));
-    eField[1] = E_0 * xe * ye * (m_eps * m_eps * S[2] + m_eps * m_eps * m_eps
-        * m_eps * (rho2 * S[4] - rho2 * rho2 * S[5] / 4.0));
-    eField[2] = E_0 * xe * (m_eps * C[1] + m_eps * m_eps * m_eps * (-C[2] / 2.0 +
-        rho2 * C[3] - rho2 * rho2 * C[4] / 4.0));
-    bField[0] = 0;
-    bField[1] = E_0 * (S[0] + m_eps * m_eps * (rho2 * S[2] / 2.0 - rho2 * rho2
-        * S[3] / 4.0) + m_eps * m_eps * m_eps * m_eps * (- S[2] / 8.0 + rho2
-        * S[3] / 4.0 + 5.0 * rho2 * rho2 * S[4] / 16.0 - rho2 * rho2 * rho2
-        * S[5] / 4.0 + rho2 * rho2 *rho2 * rho2 * S[6] / 32.0));
-    bField[2] = E_0 * ye * (m_eps * C[1] + m_eps * m_eps * m_eps * (C[2] / 2.0
-        + rho2 * C[3] / 2.0 - rho2 * rho2 * C[4] / 4.0));
-    eField[0] = eField[0] * std::cos(m_polAngle)
-        - eField[1] * std::sin(m_polAngle) ;
-    eField[1] = eField[0] * std::sin(m_polAngle)
-        + eField[1] * std::cos(m_polAngle);
-    eField = m_rotationInv * eField;
-    bField[0] = bField[0] * std::cos(m_polAngle)
-        - bField[1] * std::sin(m_polAngle) ;
-    bField[1] = bField[0] * std::sin(m_polAngle)
-        + bField[1] * std::cos(m_polAngle);
-    bField = m_rotationInv * bField;
-}
\ No newline at end of file
+bool FocusingField::InSupport(double time, const ThreeVector &position) const
+{
+    ThreeVector position_p = m_alongZ ? position : m_rotaion * position;
+    double r2 = position_p[0] * position_p[0] + position_p[1] * position_p[1];
+    double ze = position_p[2] / m_rayleigh;
+    double tRel = time - m_t0 - position_p[2];
+    return r2 / (m_waist * m_waist * (1.0 + ze * ze)) + tRel * tRel * m_invTau2
+        < envelopeCutoff;
+}
+
+// As for GaussianEMField::EntryTime
+double FocusingField::EntryTime(double time, const ThreeVector &position,
+    const ThreeVector &velocity) const
+{
+    ThreeVector position_p = m_alongZ ? position : m_rotaion * position;
+    ThreeVector velocity_p = m_alongZ ? velocity : m_rotaion * velocity;
+    double halfWidth = std::sqrt(envelopeCutoff) * m_tau;
+    double offset = time - m_t0 - position_p[2];
+    double rate = 1.0 - velocity_p[2];
+    double never = std::numeric_limits<double>::infinity();
+    if (offset >= halfWidth) return never;
+    if (offset > -halfWidth) return time;
+    return rate > 0 ? time + (-halfWidth - offset) / rate : never;
+}
@@ -23,6 +23,25 @@ public:
     void GetField(double time, const ThreeVector &position, ThreeVector &eField,
         ThreeVector &bField) const override;
 
+    void GetFields(FieldBatch &batch) const override;
+
+    // Within envelopeCutoff of the envelope peak
+    bool InSupport(double time, const ThreeVector &position) const override;
+
+    // When the particle reaches the pulse duration, ignoring the waist
+    double EntryTime(double time, const ThreeVector &position,
+        const ThreeVector &velocity) const override;
+
+private:
+    // Fields at n points, shared by GetField and GetFields. The rotation
+    // into the beam frame is skipped for beams along the z axis
+    template <bool rotate>
+    void Evaluate(unsigned int n, const double* time, const double* xPos,
+        const double* yPos, const double* zPos, double* xE, double* yE,
+        double* zE, double* xB, double* yB, double* zB) const;
+
+public:
+
     double m_maxE;  // Beam max intensity
     double m_waveLength;    // wavelength
     double m_tau;   // duration of beam
@@ -33,6 +52,10 @@ public:
     double m_rayleigh;  // rayleight length
     double m_eps;       // divergence angle
     double m_t0;        // time from start to focus
+    double m_invTau2;   // 1 / tau^2
+    double m_cosPol;    // cos and sin of the polarisation angle
+    double m_sinPol;
+    bool m_alongZ;      // beam travels along z so needs no rotation
 
     ThreeMatrix m_rotaion;  // Matrix to rotate so beam goes inb z axis
     ThreeMatrix m_rotationInv;  // Matrix to rotate back
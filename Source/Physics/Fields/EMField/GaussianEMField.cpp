@@ -1,7 +1,9 @@
 #include <cmath>
+#include <limits>
 
 #include "GaussianEMField.hh"
 #include "UnitsSystem.hh"
+#include "VecMath.hh"
 
 GaussianEMField::GaussianEMField()
 {
@@ -18,41 +20,113 @@ m_maxE(maxE), m_waveLength(waveLength), m_tau(tau), m_waist(waist), m_polAngle(p
 	m_rotaion = m_waveVec.RotateToAxis(ThreeVector(0,0,1));
 	m_rotationInv = m_rotaion.Inverse();
 	m_waveNum = 2.0 * UnitsSystem::pi / m_waveLength;
+	m_t0 = (m_startPos - m_focusPos).Mag();
+	m_rayleigh = m_waveNum * m_waist * m_waist / 2.0;
+	m_invTau2 = 1.0 / (m_tau * m_tau);
+	m_eDir = m_rotationInv * ThreeVector(std::cos(m_polAngle),
+		std::sin(m_polAngle), 0);
+	m_bDir = m_rotationInv * ThreeVector(std::sin(m_polAngle),
+		std::cos(m_polAngle), 0);
+	m_alongZ = (m_waveVec - ThreeVector(0,0,1)).Mag2() < 1e-30;
 }
 
 GaussianEMField::~GaussianEMField()
 {
 }
 
+template <bool rotate>
+void GaussianEMField::Evaluate(unsigned int n, const double* time,
+	const double* xPos, const double* yPos, const double* zPos, double* xE,
+	double* yE, double* zE, double* xB, double* yB, double* zB) const
+{
+	#pragma omp simd
+	for (unsigned int point = 0; point < n; point++)
+	{
+		double x = xPos[point], y = yPos[point], z = zPos[point];
+		double xp = x, yp = y, zp = z;
+		if (rotate)
+		{
+			xp = m_rotaion[0][0] * x + m_rotaion[0][1] * y + m_rotaion[0][2] * z;
+			yp = m_rotaion[1][0] * x + m_rotaion[1][1] * y + m_rotaion[1][2] * z;
+			zp = m_rotaion[2][0] * x + m_rotaion[2][1] * y + m_rotaion[2][2] * z;
+		}
+		double r2 = xp * xp + yp * yp;
+		// Adding small number to stop divergence at zero
+		double curvature = zp + m_rayleigh * m_rayleigh / (zp + 1e-99);
+		double waistRatio2 = 1.0 + zp * zp / (m_rayleigh * m_rayleigh);
+		double tRel = time[point] - m_t0 - zp;
+		// The spatial and temporal envelopes share one exponential
+		double E0 = m_maxE / std::sqrt(waistRatio2)
+			* VecMath::Exp(-r2 / (m_waist * m_waist * waistRatio2)
+				- tRel * tRel * m_invTau2)
+			* VecMath::Cos(zp * m_waveNum + r2 * m_waveNum / (2.0 * curvature));
+
+		xE[point] = E0 * m_eDir[0];
+		yE[point] = E0 * m_eDir[1];
+		zE[point] = E0 * m_eDir[2];
+		xB[point] = E0 * m_bDir[0];
+		yB[point] = E0 * m_bDir[1];
+		zB[point] = E0 * m_bDir[2];
+	}
+}
+
 void GaussianEMField::GetField(double time, const ThreeVector &position,
 						  ThreeVector &eField, ThreeVector &bField) const
 {
-	ThreeVector position_p = m_rotaion * position;
-	double t0 		 = (m_startPos - m_focusPos).Mag();
-	double r2 		 = position_p[0] * position_p[0] + position_p[1] * position_p[1];
-	double rayleigh  = m_waveNum * m_waist * m_waist / 2.0;
-	double curvature = (position_p[2] + rayleigh * rayleigh
-										/ (position_p[2] + 1e-99));
-	// Adding small number to stop divergence at zero
-	double beamWaist = m_waist * std::sqrt(1.0 + position_p[2] * position_p[2] 
-										   / (rayleigh * rayleigh));
-	double E0 = m_maxE * (m_waist / beamWaist) 
-				* std::exp(-1.0 * r2 / (beamWaist * beamWaist))
-				* std::cos(position_p[2] * m_waveNum + r2 * m_waveNum / (2.0 * curvature)) 
-				* std::exp(-1.0 * (time - t0 - position_p[2]) 
-							* (time - t0 - position_p[2]) / (m_tau * m_tau));
-	
-	eField[0] = E0 * std::cos(m_polAngle);
-	eField[1] = E0 * std::sin(m_polAngle);
-	eField[2] = 0;
-	eField = m_rotationInv * eField;
+	double x = position[0], y = position[1], z = position[2];
+	if (m_alongZ)
+	{
+		Evaluate<false>(1, &time, &x, &y, &z, &eField[0], &eField[1],
+			&eField[2], &bField[0], &bField[1], &bField[2]);
+	} else
+	{
+		Evaluate<true>(1, &time, &x, &y, &z, &eField[0], &eField[1],
+			&eField[2], &bField[0], &bField[1], &bField[2]);
+	}
+}
+
+void GaussianEMField::GetFields(FieldBatch &batch) const
+{
+	if (m_alongZ)
+	{
+		Evaluate<false>(batch.size, batch.time, batch.xPos, batch.yPos,
+			batch.zPos, batch.xE, batch.yE, batch.zE, batch.xB, batch.yB,
+			batch.zB);
+	} else
+	{
+		Evaluate<true>(batch.size, batch.time, batch.xPos, batch.yPos,
+			batch.zPos, batch.xE, batch.yE, batch.zE, batch.xB, batch.yB,
+			batch.zB);
+	}
+}
 
-	bField[0] = E0 * std::sin(m_polAngle);
-	bField[1] = E0 * std::cos(m_polAngle);
-	bField[2] = 0;
-	bField = m_rotationInv * bField;
+bool GaussianEMField::InSupport(double time, const ThreeVector &position) const
+{
+	ThreeVector position_p = m_alongZ ? position : m_rotaion * position;
+	double r2 = position_p[0] * position_p[0] + position_p[1] * position_p[1];
+	double ze = position_p[2] / m_rayleigh;
+	double tRel = time - m_t0 - position_p[2];
+	return r2 / (m_waist * m_waist * (1.0 + ze * ze)) + tRel * tRel * m_invTau2
+		< envelopeCutoff;
 }
 
+/* The pulse peak is at time - t0 - z' = 0 in the beam frame, and the support
+   lies within sqrt(envelopeCutoff) tau of it. Along a straight line at less
+   than c that offset only grows, at 1 - v_z', so the pulse reaches the
+   particle at most once and does not return once it has passed */
+double GaussianEMField::EntryTime(double time, const ThreeVector &position,
+	const ThreeVector &velocity) const
+{
+	ThreeVector position_p = m_alongZ ? position : m_rotaion * position;
+	ThreeVector velocity_p = m_alongZ ? velocity : m_rotaion * velocity;
+	double halfWidth = std::sqrt(envelopeCutoff) * m_tau;
+	double offset = time - m_t0 - position_p[2];
+	double rate = 1.0 - velocity_p[2];
+	double never = std::numeric_limits<double>::infinity();
+	if (offset >= halfWidth) return never;
+	if (offset > -halfWidth) return time;
+	return rate > 0 ? time + (-halfWidth - offset) / rate : never;
+}
 
 /*
 void GaussianEMField::SaveField(HDF5Output &file, const std::vector<double> &tAxis,
@@ -1,6 +1,8 @@
 #ifndef GaussianEMField_HH
 #define GaussianEMField_HH
 
+#include <cmath>
+
 #include "EMField.hh"
 #include "ThreeVector.hh"
 #include "ThreeMatrix.hh"
@@ -23,7 +25,26 @@ public:
 	virtual void GetField(double time, const ThreeVector &position,
 						  ThreeVector &eField, ThreeVector &bField) const;
 
+	virtual void GetFields(FieldBatch &batch) const;
+
+	// Within envelopeCutoff of the envelope peak
+	virtual bool InSupport(double time, const ThreeVector &position) const;
+
+	// When the particle reaches the pulse duration, ignoring the waist
+	virtual double EntryTime(double time, const ThreeVector &position,
+		const ThreeVector &velocity) const;
+
+	// E and B both peak at the amplitude
+	virtual double MaxStrength() const {return 2.0 * std::fabs(m_maxE);}
+
 private:
+	// Fields at n points, shared by GetField and GetFields. The rotation into
+	// the beam frame is skipped for beams along the z axis
+	template <bool rotate>
+	void Evaluate(unsigned int n, const double* time, const double* xPos,
+		const double* yPos, const double* zPos, double* xE, double* yE,
+		double* zE, double* xB, double* yB, double* zB) const;
+
 	double m_maxE;	// Beam max intensity
 	double m_waveLength;	// wavelength
 	double m_tau;	// duration of beam
@@ -37,5 +58,13 @@ private:
 	ThreeVector m_waveVec; // Wave vector of beam
 	ThreeVector m_startPos;	// Start positipon of laser
 	ThreeVector m_focusPos;	// focus point of beam
+
+	// Constants of the field formula, worked out once
+	double m_t0;	// time from start to focus
+	double m_rayleigh;	// Rayleigh length
+	double m_invTau2;	// 1 / tau^2
+	ThreeVector m_eDir;	// Lab frame directions of E and B
+	ThreeVector m_bDir;
+	bool m_alongZ;	// beam travels along z so needs no rotation
 };
 #endif
\ No newline at end of file
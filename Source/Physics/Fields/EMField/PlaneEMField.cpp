@@ -1,6 +1,7 @@
 #include "PlaneEMField.hh"
 #include "ThreeVector.hh"
 #include "UnitsSystem.hh"
+#include "VecMath.hh"
 
 PlaneEMField::PlaneEMField()
 {
@@ -29,8 +30,37 @@ void PlaneEMField::GetField(double time, const ThreeVector &position,
     eField[2] = 0;
     eField = m_rotationInv * eField;
 
-    bField[0] = E0 * std::sin(m_polAngle);
+    bField[0] = -E0 * std::sin(m_polAngle);
     bField[1] = E0 * std::cos(m_polAngle);
     bField[2] = 0;
     bField = m_rotationInv * bField;
-}
\ No newline at end of file
+}
+
+void PlaneEMField::GetFields(FieldBatch &batch) const
+{
+    // Only the phase depends on the point
+    double zRot[3], eDir[3], bDir[3];
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        zRot[i] = m_rotaion[2][i];
+        eDir[i] = m_rotationInv[i][0] * std::cos(m_polAngle)
+            + m_rotationInv[i][1] * std::sin(m_polAngle);
+        bDir[i] = -m_rotationInv[i][0] * std::sin(m_polAngle)
+            + m_rotationInv[i][1] * std::cos(m_polAngle);
+    }
+    double maxE = m_maxE, waveNum = m_waveNum;
+
+    #pragma omp simd
+    for (unsigned int i = 0; i < batch.size; i++)
+    {
+        double zp = zRot[0] * batch.xPos[i] + zRot[1] * batch.yPos[i]
+            + zRot[2] * batch.zPos[i];
+        double E0 = maxE * VecMath::Cos((zp - batch.time[i]) * waveNum);
+        batch.xE[i] = E0 * eDir[0];
+        batch.yE[i] = E0 * eDir[1];
+        batch.zE[i] = E0 * eDir[2];
+        batch.xB[i] = E0 * bDir[0];
+        batch.yB[i] = E0 * bDir[1];
+        batch.zB[i] = E0 * bDir[2];
+    }
+}
@@ -1,6 +1,8 @@
 #ifndef PlaneEMField_HH
 #define PlaneEMField_HH
 
+#include <cmath>
+
 #include "EMField.hh"
 #include "ThreeVector.hh"
 #include "ThreeMatrix.hh"
@@ -19,6 +21,28 @@ public:
     void GetField(double time, const ThreeVector &position,
                   ThreeVector &eField, ThreeVector &bField) const override;
 
+    void GetFields(FieldBatch &batch) const override;
+
+    // E and B both peak at the amplitude
+    double MaxStrength() const override {return 2.0 * std::fabs(m_maxE);}
+
+    double GetMaxE() const {return m_maxE;}
+
+    double GetWaveNumber() const {return m_waveNum;}
+
+    // Direction the wave travels in
+    ThreeVector GetDirection() const
+    {
+        return m_rotationInv * ThreeVector(0, 0, 1);
+    }
+
+    // Direction of the electric field, B is along GetDirection() x this
+    ThreeVector GetPolarisation() const
+    {
+        return m_rotationInv * ThreeVector(std::cos(m_polAngle),
+            std::sin(m_polAngle), 0);
+    }
+
 private:
     double m_maxE;          // Beam max intensity
     double m_waveLength;    // wavelength
@@ -15,4 +15,20 @@ void StaticEMField::GetField(double time, const ThreeVector &position,
 {
 	eField = m_eField;
 	bField = m_bField;
-}
\ No newline at end of file
+}
+
+void StaticEMField::GetFields(FieldBatch &batch) const
+{
+	double eField[3] = {m_eField[0], m_eField[1], m_eField[2]};
+	double bField[3] = {m_bField[0], m_bField[1], m_bField[2]};
+	#pragma omp simd
+	for (unsigned int i = 0; i < batch.size; i++)
+	{
+		batch.xE[i] = eField[0];
+		batch.yE[i] = eField[1];
+		batch.zE[i] = eField[2];
+		batch.xB[i] = bField[0];
+		batch.yB[i] = bField[1];
+		batch.zB[i] = bField[2];
+	}
+}
@@ -14,6 +14,13 @@ public:
 	virtual void GetField(double time, const ThreeVector &position,
 						  ThreeVector &eField, ThreeVector &bField) const;
 
+	virtual void GetFields(FieldBatch &batch) const;
+
+	virtual double MaxStrength() const
+	{
+		return m_eField.Mag() + m_bField.Mag();
+	}
+
 private:
 	ThreeVector m_eField;
 	ThreeVector m_bField;
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+
+#include "AdaptiveStepper.hh"
+#include "UnitsSystem.hh"
+
+AdaptiveStepper::AdaptiveStepper(ParticlePusher* pusher,
+    const std::vector<Process*>& processes, double minStep,
+    double gyroFraction, double maxOpticalDepth, const StepTasks* tasks):
+m_pusher(pusher), m_processes(processes), m_minStep(minStep),
+m_gyroFraction(gyroFraction), m_maxOpticalDepth(maxOpticalDepth),
+m_tasks(tasks), m_steps(0), m_substeps(0)
+{
+}
+
+void AdaptiveStepper::Step(ParticleList* partList, double dt) const
+{
+    // Ballistic photons are moved all at once by the photon clock, the rest
+    // are split by level a block at a time
+    partList->AdvancePhotons(dt);
+    unsigned int nPart = partList->GetNPart();
+    if (m_tasks != nullptr)
+    {
+        m_tasks->ForEachRange(partList,
+            [&](unsigned int begin, unsigned int end)
+            {
+                StepRange(partList, begin, end, dt);
+            });
+    } else
+    {
+        StepRange(partList, 0, nPart, dt);
+    }
+
+    for (unsigned int k = 0; k < nPart; k++)
+    {
+        if (partList->IsBallistic(k) == false) continue;
+        for (unsigned int proc = 0; proc < m_processes.size(); proc++)
+        {
+            m_processes[proc]->Interact(partList, k, dt);
+        }
+    }
+}
+
+void AdaptiveStepper::StepRange(ParticleList* partList, unsigned int begin,
+    unsigned int end, double dt) const
+{
+    unsigned int block[FieldBatch::capacity];
+    unsigned int levels[maxLevel + 1][FieldBatch::capacity];
+    unsigned int nLevel[maxLevel + 1];
+    unsigned long steps = 0, substeps = 0;
+    unsigned int i = begin;
+    while (i < end)
+    {
+        unsigned int n = 0;
+        for (; i < end && n < FieldBatch::capacity; i++)
+        {
+            if (partList->IsAlive(i) && !partList->IsBallistic(i))
+            {
+                block[n++] = i;
+            }
+        }
+        if (n == 0) continue;
+
+        // The fields at the start are usually cached from the end of the
+        // last step. Those where each particle would be at the end if it
+        // went straight catch it running into a stronger field
+        const EMField* field = m_pusher->GetField();
+        field->FillParticleFields(partList, block, n);
+        FieldBatch batch;
+        batch.size = n;
+        for (unsigned int j = 0; j < n; j++)
+        {
+            ThreeVector momentum = partList->GetMomentum(block[j]);
+            batch.SetPoint(j, partList->GetTime(block[j]) + dt,
+                partList->GetPosition(block[j])
+                + (dt / partList->GetGamma(block[j])) * momentum);
+        }
+        field->GetFields(batch);
+
+        std::fill(nLevel, nLevel + maxLevel + 1, 0);
+        for (unsigned int j = 0; j < n; j++)
+        {
+            ThreeVector eField, bField;
+            batch.GetField(j, eField, bField);
+            unsigned int level = partList->GetSpecies(block[j]) == Species::Photon
+                ? 0 : Level(partList, block[j], dt, eField.Mag() + bField.Mag());
+            levels[level][nLevel[level]++] = block[j];
+        }
+
+        for (unsigned int level = 0; level <= maxLevel; level++)
+        {
+            if (nLevel[level] == 0) continue;
+            unsigned int nSub = 1u << level;
+            double subStep = dt / nSub;
+            for (unsigned int sub = 0; sub < nSub; sub++)
+            {
+                m_pusher->PushParticles(partList, levels[level], nLevel[level],
+                    subStep);
+                for (unsigned int j = 0; j < nLevel[level]; j++)
+                {
+                    for (unsigned int proc = 0; proc < m_processes.size(); proc++)
+                    {
+                        m_processes[proc]->Interact(partList, levels[level][j],
+                            subStep);
+                    }
+                }
+            }
+            steps += nLevel[level];
+            substeps += nLevel[level] * nSub;
+        }
+    }
+    m_steps += steps;
+    m_substeps += substeps;
+}
+
+unsigned int AdaptiveStepper::Level(ParticleList* partList,
+    unsigned int index, double dt, double endForce) const
+{
+    // Gyro-period of a unit charge and mass, E and B together bound the
+    // rate at which the momentum turns. Exact pushers need not resolve it
+    double step = dt;
+    ThreeVector eField, bField;
+    partList->GetField(index, eField, bField);
+    double startForce = eField.Mag() + bField.Mag();
+    double force = std::max(startForce, endForce);
+    if (force > 0 && m_pusher->IsExact() == false)
+    {
+        step = std::min(step, m_gyroFraction * 2.0 * UnitsSystem::pi
+            * partList->GetGamma(index) / force);
+    }
+
+    // The rates grow about as the field, so are scaled up to the end of the
+    // step if it is stronger there
+    double rate = 0;
+    for (unsigned int proc = 0; proc < m_processes.size(); proc++)
+    {
+        rate += m_processes[proc]->OpticalDepthChange(partList, index, 1.0);
+    }
+    if (rate > 0)
+    {
+        step = std::min(step, m_maxOpticalDepth * startForce / (rate * force));
+    }
+
+    unsigned int level = 0;
+    double subStep = dt;
+    while (level < maxLevel && subStep > step && subStep / 2.0 >= m_minStep)
+    {
+        subStep /= 2.0;
+        level++;
+    }
+    return level;
+}
+
+void AdaptiveStepper::PrintStats(std::ostream& out) const
+{
+    unsigned long steps = m_steps;
+    out << "Adaptive stepping: " << (steps > 0 ? double(m_substeps) / steps : 0)
+        << " substeps per lepton step on average\n";
+}
@@ -0,0 +1,59 @@
+#ifndef ADAPTIVESTEPPER_HH
+#define ADAPTIVESTEPPER_HH
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+
+#include "ParticlePusher.hh"
+#include "Process.hh"
+#include "StepTasks.hh"
+
+/* Moves the particles of an event through a step with each lepton choosing
+   its own time step. A lepton splits the step into 2^n substeps, the fewest
+   for which a substep is at most gyroFraction of its gyro-period in the local
+   field and uses up at most maxOpticalDepth in the processes, unless that
+   would take the substep below minStep. Leptons taking the same number of
+   substeps are pushed together. Photons go straight so take the whole step.
+   Large events have their steps split between threads by the step tasks,
+   if given. The pusher, processes and tasks are not owned by the stepper. */
+class AdaptiveStepper
+{
+public:
+    AdaptiveStepper(ParticlePusher* pusher,
+        const std::vector<Process*>& processes, double minStep,
+        double gyroFraction = 0.05, double maxOpticalDepth = 0.1,
+        const StepTasks* tasks = nullptr);
+
+    /* Moves every particle in the list through a time dt, which may be
+       shorter than the step of the pusher, applying the processes after each
+       substep. Secondaries wait for the next step */
+    void Step(ParticleList* partList, double dt) const;
+
+    // Number of times n the lepton at index halves a step of dt, given the
+    // strength |E| + |B| of the field at the end of the step. The fields at
+    // the particle must have been filled
+    unsigned int Level(ParticleList* partList, unsigned int index, double dt,
+        double endForce) const;
+
+    // Average number of substeps the leptons took in each step
+    void PrintStats(std::ostream& out) const;
+
+private:
+    // Steps the particles from begin up to end
+    void StepRange(ParticleList* partList, unsigned int begin,
+        unsigned int end, double dt) const;
+
+    static const unsigned int maxLevel = 16;
+
+    ParticlePusher* m_pusher;
+    std::vector<Process*> m_processes;
+    double m_minStep;           // Shortest substep a lepton chooses
+    double m_gyroFraction;      // Longest substep in gyro-periods
+    double m_maxOpticalDepth;   // Largest optical depth used in a substep
+    const StepTasks* m_tasks;
+
+    mutable std::atomic<unsigned long> m_steps;
+    mutable std::atomic<unsigned long> m_substeps;
+};
+#endif
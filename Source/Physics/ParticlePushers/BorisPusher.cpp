@@ -0,0 +1,24 @@
+#include <cmath>
+
+#include "BorisPusher.hh"
+
+BorisPusher::BorisPusher(EMField* field, double dt,
+    RadiationReaction radReaction):
+SplitStepPusher(field, dt, radReaction)
+{
+}
+
+ThreeVector BorisPusher::Rotate(double mass, double charge,
+    const ThreeVector &momentum, const ThreeVector &Efield,
+    const ThreeVector &Bfield, double dt) const
+{
+    // Half electric kick, magnetic rotation, half electric kick
+    double halfKick = charge * dt / 2.0;
+    ThreeVector pMinus = momentum + halfKick * Efield;
+    double gamma = std::sqrt(1.0 + pMinus.Mag2() / (mass * mass));
+    ThreeVector t = (halfKick / (mass * gamma)) * Bfield;
+    ThreeVector s = (2.0 / (1.0 + t.Mag2())) * t;
+    ThreeVector pPrime = pMinus + pMinus.Cross(t);
+    ThreeVector pPlus = pMinus + pPrime.Cross(s);
+    return pPlus + halfKick * Efield;
+}
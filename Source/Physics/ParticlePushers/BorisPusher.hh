@@ -0,0 +1,19 @@
+#ifndef BORISPUSHER_HH
+#define BORISPUSHER_HH
+
+#include "SplitStepPusher.hh"
+
+/* Boris (1970) rotation, the standard volume preserving scheme. Its
+   average velocity is wrong in crossed fields where E + v x B = 0 */
+class BorisPusher: public SplitStepPusher
+{
+public:
+    BorisPusher(EMField* field, double dt,
+        RadiationReaction radReaction = RadiationReaction::None);
+
+protected:
+    ThreeVector Rotate(double mass, double charge, const ThreeVector &momentum,
+        const ThreeVector &Efield, const ThreeVector &Bfield,
+        double dt) const override;
+};
+#endif
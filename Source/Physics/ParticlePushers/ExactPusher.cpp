@@ -0,0 +1,57 @@
+#include <cmath>
+
+#include "ExactPusher.hh"
+
+ExactPusher::ExactPusher(EMField* field, double dt):
+ParticlePusher(field, dt)
+{
+}
+
+ExactPusher::~ExactPusher()
+{
+}
+
+void ExactPusher::PushParticles(ParticleList* partList,
+    const unsigned int* indices, unsigned int n, double dt)
+{
+    unsigned int leptons[FieldBatch::capacity];
+    FieldBatch batch;
+    batch.size = 0;
+    for (unsigned int j = 0; j < n; j++)
+    {
+        unsigned int index = indices[j];
+        if (partList->IsAlive(index) == false) continue;
+        if (partList->GetSpecies(index) == Species::Photon)
+        {
+            PushPhoton(partList, index, dt);
+            continue;
+        }
+        ThreeVector position = partList->GetPosition(index);
+        ThreeVector momentum = partList->GetMomentum(index);
+        Advance(partList->GetMass(index), partList->GetCharge(index),
+            partList->GetTime(index), position, momentum, dt);
+        partList->UpdateTrack(index, position, momentum);
+        partList->UpdateTime(index, dt);
+        leptons[batch.size] = index;
+        batch.SetPoint(batch.size, partList->GetTime(index), position);
+        batch.size++;
+    }
+    if (batch.size == 0) return;
+
+    // Fields at the end of the step for the processes
+    m_field->GetFields(batch);
+    for (unsigned int j = 0; j < batch.size; j++)
+    {
+        ThreeVector eField, bField;
+        batch.GetField(j, eField, bField);
+        partList->SetField(leptons[j], eField, bField);
+    }
+}
+
+ThreeVector ExactPusher::PushMomentum(double mass, double charge,
+    const ThreeVector &momentum, const ThreeVector &Efield,
+    const ThreeVector &Bfield) const
+{
+    double gamma = std::sqrt(1.0 + momentum.Mag2() / (mass * mass));
+    return charge * (Efield + momentum.Cross(Bfield) / (mass * gamma));
+}
@@ -0,0 +1,33 @@
+#ifndef EXACTPUSHER_HH
+#define EXACTPUSHER_HH
+
+#include "ParticlePusher.hh"
+
+/* Pushers for fields in which the Lorentz force has a closed form solution,
+   so a particle is moved exactly however long the step. There is no
+   radiation reaction, the particles only lose energy to the stochastic
+   processes between steps. Derived classes give the solution, the fields at
+   the end of the step are left in the cache for the processes. */
+class ExactPusher: public ParticlePusher
+{
+public:
+    ExactPusher(EMField* field, double dt);
+
+    virtual ~ExactPusher();
+
+    void PushParticles(ParticleList* partList, const unsigned int* indices,
+        unsigned int n, double dt) override;
+
+    bool IsExact() const override {return true;}
+
+protected:
+    // Moves a particle starting at time through time dt
+    virtual void Advance(double mass, double charge, double time,
+        ThreeVector &position, ThreeVector &momentum, double dt) const = 0;
+
+    // Lorentz force
+    ThreeVector PushMomentum(double mass, double charge,
+        const ThreeVector &momentum, const ThreeVector &Efield,
+        const ThreeVector &Bfield) const override;
+};
+#endif
@@ -0,0 +1,29 @@
+#include <cmath>
+
+#include "HigueraCaryPusher.hh"
+
+HigueraCaryPusher::HigueraCaryPusher(EMField* field, double dt,
+    RadiationReaction radReaction):
+SplitStepPusher(field, dt, radReaction)
+{
+}
+
+ThreeVector HigueraCaryPusher::Rotate(double mass, double charge,
+    const ThreeVector &momentum, const ThreeVector &Efield,
+    const ThreeVector &Bfield, double dt) const
+{
+    // As Boris but the rotation uses the gamma at the middle of the step,
+    // found from the invariants of the rotation. Works with u = p / m
+    double epsilon = charge * dt / (2.0 * mass);
+    ThreeVector uMinus = momentum / mass + epsilon * Efield;
+    ThreeVector tau = epsilon * Bfield;
+    double uStar = uMinus.Dot(tau);
+    double tau2 = tau.Mag2();
+    double sigma = 1.0 + uMinus.Mag2() - tau2;
+    double gammaNew = std::sqrt(0.5 * (sigma + std::sqrt(sigma * sigma
+        + 4.0 * (tau2 + uStar * uStar))));
+    ThreeVector t = tau / gammaNew;
+    double s = 1.0 / (1.0 + t.Mag2());
+    ThreeVector uPlus = s * (uMinus + uMinus.Dot(t) * t + uMinus.Cross(t));
+    return mass * (uPlus + epsilon * Efield + uPlus.Cross(t));
+}
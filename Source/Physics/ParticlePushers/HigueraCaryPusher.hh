@@ -0,0 +1,19 @@
+#ifndef HIGUERACARYPUSHER_HH
+#define HIGUERACARYPUSHER_HH
+
+#include "SplitStepPusher.hh"
+
+/* Higuera and Cary (2017) scheme, volume preserving like Boris and with
+   the correct drift in crossed fields like Vay */
+class HigueraCaryPusher: public SplitStepPusher
+{
+public:
+    HigueraCaryPusher(EMField* field, double dt,
+        RadiationReaction radReaction = RadiationReaction::None);
+
+protected:
+    ThreeVector Rotate(double mass, double charge, const ThreeVector &momentum,
+        const ThreeVector &Efield, const ThreeVector &Bfield,
+        double dt) const override;
+};
+#endif
@@ -13,8 +13,5 @@ protected:
     ThreeVector PushMomentum(double mass, double charge,
         const ThreeVector &momentum, const ThreeVector &Efield,
         const ThreeVector &Bfield) const override;
-
-private:
-    double gaunt(double eta) const;
 };
 #endif
\ No newline at end of file
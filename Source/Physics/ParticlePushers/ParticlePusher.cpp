@@ -1,4 +1,14 @@
+#include <cmath>
+
 #include "ParticlePusher.hh"
+#include "LorentzPusher.hh"
+#include "LandauPusher.hh"
+#include "ModifiedLandauPusher.hh"
+#include "BorisPusher.hh"
+#include "VayPusher.hh"
+#include "HigueraCaryPusher.hh"
+#include "StaticFieldPusher.hh"
+#include "PlaneWavePusher.hh"
 
 ParticlePusher::ParticlePusher(EMField* field, double dt):
 m_field(field), m_dt(dt)
@@ -9,66 +19,236 @@ ParticlePusher::~ParticlePusher()
 {
 }
 
-void ParticlePusher::PushParticle(Particle *part)
+ParticlePusher* ParticlePusher::Create(const std::string& name, EMField* field,
+    double dt, RadiationReaction radReaction)
 {
-    if (part->IsAlive() == false) return;
-    if (part->GetMass() == 0)
+    if (name == "RK4" || name == "rk4")
+    {
+        if (radReaction == RadiationReaction::Landau)
+        {
+            return new LandauPusher(field, dt);
+        } else if (radReaction == RadiationReaction::ModifiedLandau)
+        {
+            return new ModifiedLandauPusher(field, dt);
+        }
+        return new LorentzPusher(field, dt);
+    } else if (name == "Boris" || name == "boris")
+    {
+        return new BorisPusher(field, dt, radReaction);
+    } else if (name == "Vay" || name == "vay")
+    {
+        return new VayPusher(field, dt, radReaction);
+    } else if (name == "HigueraCary" || name == "higueracary")
     {
-        ThreeVector positionNew = part->GetPosition() + (m_dt / part->GetMomentum().Mag())
-                                 * part->GetMomentum();
-        part->UpdateTrack(positionNew, part->GetMomentum());
-        part->UpdateTime(m_dt);
-    } else  // Particle is charged
+        return new HigueraCaryPusher(field, dt, radReaction);
+    } else if ((name == "Exact" || name == "exact")
+        && radReaction == RadiationReaction::None)
     {
-        ThreeVector posK1, posK2, posK3, posK4;
-        ThreeVector momK1, momK2, momK3, momK4;
-        ThreeVector eField, bField;
-
-        m_field->GetField(part->GetTime(), part->GetPosition(), eField, bField);
-        posK1 = PushPosition(part->GetMass(), part->GetMomentum());
-        momK1 = PushMomentum(part->GetMass(), part->GetCharge(),
-                             part->GetMomentum(),
-                             eField, bField);
-        
-        m_field->GetField(part->GetTime() + m_dt / 2.0,
-                          part->GetPosition() + posK1 * m_dt / 2.0,
-                          eField, bField);
-        posK2 = PushPosition(part->GetMass(), part->GetMomentum() + momK1 * m_dt / 2.0);
-        momK2 = PushMomentum(part->GetMass(), part->GetCharge(), 
-                             part->GetMomentum() + momK1 * m_dt / 2.0,
-                             eField, bField);
-
-        m_field->GetField(part->GetTime() + m_dt / 2.0,
-                          part->GetPosition() + posK2 * m_dt / 2.0,
-                          eField, bField);
-        posK3 = PushPosition(part->GetMass(), part->GetMomentum() + momK2 * m_dt / 2.0);
-        momK3 = PushMomentum(part->GetMass(), part->GetCharge(),
-                             part->GetMomentum() + momK2 * m_dt / 2.0,
-                             eField, bField);
-
-        m_field->GetField(part->GetTime() + m_dt,
-                          part->GetPosition() + posK3 * m_dt,
-                          eField, bField);
-        posK4 = PushPosition(part->GetMass(), part->GetMomentum() + momK3 * m_dt);
-        momK4 = PushMomentum(part->GetMass(), part->GetCharge(),
-                             part->GetMomentum() + momK3 * m_dt,
-                             eField, bField);
-
-        ThreeVector positionNew = part->GetPosition() + (m_dt / 6.0) 
-                                  * (posK1 + 2.0 * posK2 + 2.0 * posK3 + posK4);
-        ThreeVector momentumNew = part->GetMomentum() + (m_dt / 6.0) 
-                                  * (momK1 + 2.0 * momK2 + 2.0 * momK3 + momK4);
-        part->UpdateTrack(positionNew, momentumNew);
-        part->UpdateTime(m_dt);
+        if (StaticEMField* staticField = dynamic_cast<StaticEMField*>(field))
+        {
+            return new StaticFieldPusher(staticField, dt);
+        } else if (PlaneEMField* plane = dynamic_cast<PlaneEMField*>(field))
+        {
+            return new PlaneWavePusher(plane, dt);
+        }
     }
+    return nullptr;
+}
+
+void ParticlePusher::PushParticle(ParticleList* partList, unsigned int index)
+{
+    PushParticles(partList, &index, 1, m_dt);
 }
 
 void ParticlePusher::PushParticleList(ParticleList* partList)
 {
-    for (unsigned int i = 0; i < partList->GetNPart(); i++)
+    // Ballistic photons are moved all at once by the photon clock
+    partList->AdvancePhotons(m_dt);
+    PushParticleRange(partList, 0, partList->GetNPart());
+}
+
+void ParticlePusher::PushParticleRange(ParticleList* partList,
+    unsigned int begin, unsigned int end)
+{
+    unsigned int indices[FieldBatch::capacity];
+    unsigned int i = begin;
+    while (i < end)
+    {
+        unsigned int n = 0;
+        for (; i < end && n < FieldBatch::capacity; i++)
+        {
+            if (partList->IsBallistic(i) == false) indices[n++] = i;
+        }
+        if (n > 0) PushParticles(partList, indices, n, m_dt);
+    }
+}
+
+unsigned int ParticlePusher::FreeStream(ParticleList* partList,
+    unsigned int maxSteps)
+{
+    unsigned int nPart = partList->GetNPart();
+    double steps = maxSteps;
+    for (unsigned int i = 0; i < nPart && steps >= 1; i++)
     {
-        PushParticle(partList->GetParticle(i));
+        if (partList->IsAlive(i) == false) continue;
+        double time = partList->GetTime(i);
+        double entry = m_field->EntryTime(time, partList->GetPosition(i),
+            Velocity(partList, i));
+        steps = std::fmin(steps, std::floor((entry - time) / m_dt));
     }
+    if (!(steps >= 1)) return 0;
+
+    unsigned int nSteps = steps;
+    double jump = nSteps * m_dt;
+    partList->AdvancePhotons(jump);
+    for (unsigned int i = 0; i < nPart; i++)
+    {
+        if (partList->IsAlive(i) == false || partList->IsBallistic(i)) continue;
+        partList->UpdateTrack(i, partList->GetPosition(i)
+            + jump * Velocity(partList, i), partList->GetMomentum(i));
+        partList->UpdateTime(i, jump);
+    }
+    return nSteps;
+}
+
+ThreeVector ParticlePusher::Velocity(const ParticleList* partList,
+    unsigned int index) const
+{
+    ThreeVector momentum = partList->GetMomentum(index);
+    if (partList->GetSpecies(index) == Species::Photon)
+    {
+        return momentum / momentum.Mag();
+    }
+    return PushPosition(partList->GetMass(index), momentum);
+}
+
+void ParticlePusher::PushParticles(ParticleList* partList,
+    const unsigned int* indices, unsigned int n, double dt)
+{
+    // Photons go straight, the leptons are pushed together
+    unsigned int leptons[FieldBatch::capacity];
+    unsigned int nLepton = 0;
+    for (unsigned int j = 0; j < n; j++)
+    {
+        if (partList->IsAlive(indices[j]) == false) continue;
+        if (partList->GetSpecies(indices[j]) == Species::Photon)
+        {
+            PushPhoton(partList, indices[j], dt);
+        } else
+        {
+            leptons[nLepton++] = indices[j];
+        }
+    }
+    if (nLepton == 0) return;
+
+    ThreeVector position[FieldBatch::capacity];
+    ThreeVector momentum[FieldBatch::capacity];
+    ThreeVector posSum[FieldBatch::capacity], momSum[FieldBatch::capacity];
+    ThreeVector posK, momK, eField, bField;
+    FieldBatch batch;
+    batch.size = nLepton;
+
+    // The start of the step is where the processes last evaluated the
+    // fields, so these are usually cached
+    m_field->FillParticleFields(partList, leptons, nLepton);
+    for (unsigned int j = 0; j < nLepton; j++)
+    {
+        unsigned int index = leptons[j];
+        double mass = partList->GetMass(index);
+        double charge = partList->GetCharge(index);
+        position[j] = partList->GetPosition(index);
+        momentum[j] = partList->GetMomentum(index);
+        partList->GetField(index, eField, bField);
+        posK = PushPosition(mass, momentum[j]);
+        momK = PushMomentum(mass, charge, momentum[j], eField, bField);
+        posSum[j] = posK;
+        momSum[j] = momK;
+        batch.SetPoint(j, partList->GetTime(index) + dt / 2.0,
+            position[j] + posK * dt / 2.0);
+        momentum[j] = momentum[j] + momK * dt / 2.0;
+    }
+
+    // Second and third stages, both at the half step. Each sets the point
+    // and momentum of the stage after it
+    for (unsigned int stage = 2; stage <= 3; stage++)
+    {
+        double offset = stage == 2 ? dt / 2.0 : dt;
+        m_field->GetFields(batch);
+        for (unsigned int j = 0; j < nLepton; j++)
+        {
+            unsigned int index = leptons[j];
+            double mass = partList->GetMass(index);
+            double charge = partList->GetCharge(index);
+            ThreeVector momStart = partList->GetMomentum(index);
+            batch.GetField(j, eField, bField);
+            posK = PushPosition(mass, momentum[j]);
+            momK = PushMomentum(mass, charge, momentum[j], eField, bField);
+            posSum[j] = posSum[j] + 2.0 * posK;
+            momSum[j] = momSum[j] + 2.0 * momK;
+            batch.SetPoint(j, partList->GetTime(index) + offset,
+                position[j] + posK * offset);
+            momentum[j] = momStart + momK * offset;
+        }
+    }
+
+    // Last stage at the end of the step
+    m_field->GetFields(batch);
+    for (unsigned int j = 0; j < nLepton; j++)
+    {
+        unsigned int index = leptons[j];
+        double mass = partList->GetMass(index);
+        double charge = partList->GetCharge(index);
+        ThreeVector momStart = partList->GetMomentum(index);
+        batch.GetField(j, eField, bField);
+        posK = PushPosition(mass, momentum[j]);
+        momK = PushMomentum(mass, charge, momentum[j], eField, bField);
+
+        ThreeVector positionNew = position[j] + (dt / 6.0)
+                                  * (posSum[j] + posK);
+        ThreeVector momentumNew = momStart + (dt / 6.0)
+                                  * (momSum[j] + momK);
+        partList->UpdateTrack(index, positionNew, momentumNew);
+        partList->UpdateTime(index, dt);
+        batch.SetPoint(j, partList->GetTime(index), positionNew);
+    }
+
+    // Fields at the end of the step, wanted by the processes and the first
+    // stage of the next step
+    m_field->GetFields(batch);
+    for (unsigned int j = 0; j < nLepton; j++)
+    {
+        batch.GetField(j, eField, bField);
+        partList->SetField(leptons[j], eField, bField);
+    }
+}
+
+void ParticlePusher::PushPhoton(ParticleList* partList,
+    unsigned int index, double dt) const
+{
+    ThreeVector momentum = partList->GetMomentum(index);
+    ThreeVector positionNew = partList->GetPosition(index)
+        + (dt / momentum.Mag()) * momentum;
+    partList->UpdateTrack(index, positionNew, momentum);
+    partList->UpdateTime(index, dt);
+}
+
+double ParticlePusher::Eta(double mass, const ThreeVector &momentum,
+    const ThreeVector &Efield, const ThreeVector &Bfield)
+{
+    double gamma = std::sqrt(1.0 + momentum.Mag2() / (mass * mass));
+    double beta  = std::sqrt(1.0 - 1.0 / (gamma * gamma));
+    ThreeVector partDir = momentum.Norm();
+    ThreeVector ePara = Efield.Dot(partDir) * partDir;
+    ThreeVector ePerp = Efield - ePara;
+    double eDotDir = partDir.Dot(Efield);
+    return std::sqrt((ePerp + beta * partDir.Cross(Bfield)).Mag2()
+        + eDotDir * eDotDir / (gamma * gamma)) * gamma;
+}
+
+double ParticlePusher::GauntFactor(double eta)
+{
+    return std::pow(1.0 + 4.8 * (1.0 + eta) * std::log(1.0 + 1.7 * eta)
+        + 2.44 * eta * eta, -2. / 3.);
 }
 
 ThreeVector ParticlePusher::PushPosition(double mass, const ThreeVector &momentum) const
@@ -1,23 +1,79 @@
 #ifndef PARTICLEPUSHER_HH
 #define PARTICLEPUSHER_HH
 
-#include "Particle.hh"
+#include <string>
+
 #include "ParticleList.hh"
 #include "EMField.hh"
 
+// Radiation reaction force applied on top of the Lorentz force
+enum class RadiationReaction
+{
+    None,
+    Landau,
+    ModifiedLandau
+};
+
 class ParticlePusher
 {
 public:
     
     ParticlePusher(EMField* field, double dt);
 
+    /* Creates a pusher by name. "RK4" gives the Lorentz, Landau or modified
+       Landau RK4 pusher, "Boris", "Vay" and "HigueraCary" give the single
+       field evaluation pushers with radiation reaction as a kick, and
+       "Exact" the closed form pusher of a static or plane wave field, without
+       radiation reaction. Returns nullptr if there is no such pusher */
+    static ParticlePusher* Create(const std::string& name, EMField* field,
+        double dt, RadiationReaction radReaction = RadiationReaction::None);
+
     virtual ~ParticlePusher();
     
-    virtual void PushParticle(Particle *part);
+    // Pushes the particle at index through one time step
+    void PushParticle(ParticleList* partList, unsigned int index);
 
+    // Pushes every particle in the list through one time step, in blocks so
+    // the fields are evaluated a batch at a time. Ballistic photons are moved
+    // by advancing the list's photon clock
     void PushParticleList(ParticleList* partList);
 
+    // Pushes the particles from begin up to end through one time step
+    // without moving the photon clock, for steps split between threads
+    void PushParticleRange(ParticleList* partList, unsigned int begin,
+        unsigned int end);
+
+    /* Pushes the n listed particles, at most FieldBatch::capacity, through
+       a time step dt. Each stage of the step makes one batched field call for
+       all the leptons, and the fields at the end of the step are cached for
+       the processes and the next step */
+    virtual void PushParticles(ParticleList* partList,
+        const unsigned int* indices, unsigned int n, double dt);
+
+    /* Moves every particle of the list in a straight line through as many
+       whole steps, up to maxSteps, as none of them can enter the support of
+       the field. Returns the number of steps, 0 if a particle may already be
+       in the field */
+    unsigned int FreeStream(ParticleList* partList, unsigned int maxSteps);
+
+    double GetTimeStep() const {return m_dt;}
+
+    // Whether a particle is pushed exactly however long the step, so steps
+    // need not resolve its motion
+    virtual bool IsExact() const {return false;}
+
+    const EMField* GetField() const {return m_field;}
+
 protected:
+    // Moves a photon in a straight line, only needed for photons pushed on
+    // their own or tracked
+    void PushPhoton(ParticleList* partList, unsigned int index,
+        double dt) const;
+
+    // Velocity of a particle, c for photons
+    ThreeVector Velocity(const ParticleList* partList,
+        unsigned int index) const;
+
     // position update function for charged particle
     ThreeVector PushPosition(double mass, const ThreeVector &momentum) const;
 
@@ -26,6 +82,13 @@ protected:
         const ThreeVector &momentum, const ThreeVector &Efield, 
         const ThreeVector &Bfield) const = 0;  
 
+    // Quantum parameter eta of a lepton, used for radiation reaction
+    static double Eta(double mass, const ThreeVector &momentum,
+        const ThreeVector &Efield, const ThreeVector &Bfield);
+
+    // Quantum reduction of the classical radiated power
+    static double GauntFactor(double eta);
+
     EMField* m_field;   // Field which particles are pushed through
     double m_dt;        // Time of each step
 };
@@ -0,0 +1,74 @@
+#include <cmath>
+
+#include "PlaneWavePusher.hh"
+
+namespace
+{
+    /* For a step in phase from phase to phase + delta, the change in
+       cos(psi) and the integral of (P - a sin(psi) e)^2, where pe = P.e and
+       p2 = P^2. Differences are taken from product formulas as delta is
+       small next to the phase */
+    void PhaseIntegrals(double phase, double delta, double a, double pe,
+        double p2, double &dCos, double &integral)
+    {
+        dCos = -2.0 * std::sin(phase + delta / 2.0) * std::sin(delta / 2.0);
+        double dSin2 = 2.0 * std::cos(2.0 * phase + delta) * std::sin(delta);
+        integral = p2 * delta + 2.0 * a * pe * dCos
+            + a * a * (delta / 2.0 - dSin2 / 4.0);
+    }
+}
+
+PlaneWavePusher::PlaneWavePusher(PlaneEMField* field, double dt):
+ExactPusher(field, dt), m_maxE(field->GetMaxE()),
+m_waveNum(field->GetWaveNumber()), m_direction(field->GetDirection()),
+m_polarisation(field->GetPolarisation())
+{
+}
+
+void PlaneWavePusher::Advance(double mass, double charge, double time,
+    ThreeVector &position, ThreeVector &momentum, double dt) const
+{
+    double k = m_waveNum;
+    double m2 = mass * mass;
+    double energy = std::sqrt(m2 + momentum.Mag2());
+    double pn = momentum.Dot(m_direction);
+    ThreeVector pPerp = momentum - pn * m_direction;
+    // Taken without cancelling for particles going with the wave
+    double h = pn > 0 ? (m2 + pPerp.Mag2()) / (energy + pn) : energy - pn;
+
+    // The transverse momentum is P - a sin(psi) e, and from it the change in
+    // phase delta = psi - psi0 gives the change in time
+    // -((m^2 + h^2) delta + I) / (2 k h^2), where I is the integral of the
+    // transverse momentum squared over the phase
+    double a = charge * m_maxE / k;
+    double phase = k * (position.Dot(m_direction) - time);
+    ThreeVector P = pPerp + (a * std::sin(phase)) * m_polarisation;
+    double pe = P.Dot(m_polarisation), p2 = P.Mag2();
+
+    // The phase falls at k h / E, less than 2k, so the step ends between
+    // -2 k dt and 0. Newton steps that leave the bracket are replaced by
+    // bisection
+    double low = -2.0 * k * dt, high = 0;
+    double delta = -k * h * dt / energy;
+    double dCos = 0, integral = 0;
+    for (unsigned int i = 0; i < 100; i++)
+    {
+        PhaseIntegrals(phase, delta, a, pe, p2, dCos, integral);
+        double elapsed = -((m2 + h * h) * delta + integral) / (2.0 * k * h * h);
+        ThreeVector pNow = P - (a * std::sin(phase + delta)) * m_polarisation;
+        double rate = -(m2 + pNow.Mag2() + h * h) / (2.0 * k * h * h);
+        if (elapsed < dt) high = delta; else low = delta;
+        double next = delta - (elapsed - dt) / rate;
+        if (!(next >= low && next <= high)) next = 0.5 * (low + high);
+        bool converged = std::fabs(next - delta) <= 1e-15 * std::fabs(delta);
+        delta = next;
+        if (converged) break;
+    }
+
+    PhaseIntegrals(phase, delta, a, pe, p2, dCos, integral);
+    ThreeVector pPerpNew = P - (a * std::sin(phase + delta)) * m_polarisation;
+    double pnNew = (m2 + pPerpNew.Mag2() - h * h) / (2.0 * h);
+    position = position - (P * delta + (a * dCos) * m_polarisation) / (k * h)
+        - (((m2 - h * h) * delta + integral) / (2.0 * k * h * h)) * m_direction;
+    momentum = pPerpNew + pnNew * m_direction;
+}
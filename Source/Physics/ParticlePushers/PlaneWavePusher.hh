@@ -0,0 +1,27 @@
+#ifndef PLANEWAVEPUSHER_HH
+#define PLANEWAVEPUSHER_HH
+
+#include "ExactPusher.hh"
+#include "PlaneEMField.hh"
+
+/* Exact motion in a plane wave. The field depends only on the phase
+   psi = k (x.n - t), along which the light front momentum h = E - p.n is
+   conserved and the transverse momentum follows the vector potential, so the
+   momentum, position and time are closed form functions of psi. The phase
+   reached after the step is found from the lab time by Newton's method. */
+class PlaneWavePusher: public ExactPusher
+{
+public:
+    PlaneWavePusher(PlaneEMField* field, double dt);
+
+protected:
+    void Advance(double mass, double charge, double time,
+        ThreeVector &position, ThreeVector &momentum, double dt) const override;
+
+private:
+    double m_maxE;
+    double m_waveNum;
+    ThreeVector m_direction;
+    ThreeVector m_polarisation;
+};
+#endif
@@ -0,0 +1,118 @@
+#include <cmath>
+
+#include "SplitStepPusher.hh"
+#include "UnitsSystem.hh"
+
+SplitStepPusher::SplitStepPusher(EMField* field, double dt,
+    RadiationReaction radReaction):
+ParticlePusher(field, dt), m_radReaction(radReaction)
+{
+}
+
+SplitStepPusher::~SplitStepPusher()
+{
+}
+
+void SplitStepPusher::PushParticles(ParticleList* partList,
+    const unsigned int* indices, unsigned int n, double dt)
+{
+    unsigned int leptons[FieldBatch::capacity];
+    unsigned int nLepton = 0;
+    for (unsigned int j = 0; j < n; j++)
+    {
+        if (partList->IsAlive(indices[j]) == false) continue;
+        if (partList->GetSpecies(indices[j]) == Species::Photon)
+        {
+            PushPhoton(partList, indices[j], dt);
+        } else
+        {
+            leptons[nLepton++] = indices[j];
+        }
+    }
+    if (nLepton == 0) return;
+
+    ThreeVector momentum[FieldBatch::capacity];
+    ThreeVector eField, bField;
+    FieldBatch batch;
+    batch.size = nLepton;
+    double halfStep = dt / 2.0;
+
+    // First half step in the start fields, usually cached, then the drift
+    m_field->FillParticleFields(partList, leptons, nLepton);
+    for (unsigned int j = 0; j < nLepton; j++)
+    {
+        unsigned int index = leptons[j];
+        double mass = partList->GetMass(index);
+        double charge = partList->GetCharge(index);
+        partList->GetField(index, eField, bField);
+        momentum[j] = Rotate(mass, charge, partList->GetMomentum(index),
+            eField, bField, halfStep);
+        if (m_radReaction != RadiationReaction::None)
+        {
+            momentum[j] = RadiationKick(mass, momentum[j], eField, bField,
+                halfStep);
+        }
+        batch.SetPoint(j, partList->GetTime(index) + dt,
+            partList->GetPosition(index) + dt * PushPosition(mass, momentum[j]));
+    }
+
+    // Second half step in the end fields, which are left in the cache
+    m_field->GetFields(batch);
+    for (unsigned int j = 0; j < nLepton; j++)
+    {
+        unsigned int index = leptons[j];
+        double mass = partList->GetMass(index);
+        double charge = partList->GetCharge(index);
+        batch.GetField(j, eField, bField);
+        if (m_radReaction != RadiationReaction::None)
+        {
+            momentum[j] = RadiationKick(mass, momentum[j], eField, bField,
+                halfStep);
+        }
+        momentum[j] = Rotate(mass, charge, momentum[j], eField, bField,
+            halfStep);
+        ThreeVector positionNew(batch.xPos[j], batch.yPos[j], batch.zPos[j]);
+        partList->UpdateTrack(index, positionNew, momentum[j]);
+        partList->UpdateTime(index, dt);
+        partList->SetField(index, eField, bField);
+    }
+}
+
+ThreeVector SplitStepPusher::PushMomentum(double mass, double charge,
+    const ThreeVector &momentum, const ThreeVector &Efield,
+    const ThreeVector &Bfield) const
+{
+    double gamma = std::sqrt(1.0 + momentum.Mag2() / (mass * mass));
+    ThreeVector force = charge * (Efield + (momentum.Cross(Bfield)
+        / (mass * gamma)));
+    if (m_radReaction != RadiationReaction::None)
+    {
+        force = force + RadiationForce(mass, momentum, Efield, Bfield);
+    }
+    return force;
+}
+
+ThreeVector SplitStepPusher::RadiationKick(double mass,
+    const ThreeVector &momentum, const ThreeVector &Efield,
+    const ThreeVector &Bfield, double dt) const
+{
+    // Midpoint rule so the splitting stays second order
+    ThreeVector midMomentum = momentum + (dt / 2.0)
+        * RadiationForce(mass, momentum, Efield, Bfield);
+    return momentum + dt * RadiationForce(mass, midMomentum, Efield, Bfield);
+}
+
+ThreeVector SplitStepPusher::RadiationForce(double mass,
+    const ThreeVector &momentum, const ThreeVector &Efield,
+    const ThreeVector &Bfield) const
+{
+    // Leading order Landau-Lifshitz force, optionally reduced by the Gaunt
+    // factor for quantum effects
+    double eta = Eta(mass, momentum, Efield, Bfield);
+    double power = (2.0 / 3.0) * UnitsSystem::alpha * eta * eta;
+    if (m_radReaction == RadiationReaction::ModifiedLandau)
+    {
+        power *= GauntFactor(eta);
+    }
+    return -power * momentum.Norm();
+}
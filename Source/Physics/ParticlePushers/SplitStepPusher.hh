@@ -0,0 +1,44 @@
+#ifndef SPLITSTEPPUSHER_HH
+#define SPLITSTEPPUSHER_HH
+
+#include "ParticlePusher.hh"
+
+/* Pushers that need one field evaluation per step instead of the four of
+   RK4. Each step is a half momentum update in the fields at the start of the
+   step, a drift, and a half update in the fields at the end of the step. The
+   start fields are the end fields of the previous step so they come from the
+   particle's field cache, and the end fields are left in the cache for the
+   processes. Derived classes give the momentum update in constant fields,
+   radiation reaction is added as a kick either side of the drift. */
+class SplitStepPusher: public ParticlePusher
+{
+public:
+    SplitStepPusher(EMField* field, double dt,
+        RadiationReaction radReaction = RadiationReaction::None);
+
+    virtual ~SplitStepPusher();
+
+    void PushParticles(ParticleList* partList, const unsigned int* indices,
+        unsigned int n, double dt) override;
+
+protected:
+    // Advances the momentum by time dt in constant fields
+    virtual ThreeVector Rotate(double mass, double charge,
+        const ThreeVector &momentum, const ThreeVector &Efield,
+        const ThreeVector &Bfield, double dt) const = 0;
+
+    // Total force, the Lorentz force plus any radiation reaction
+    ThreeVector PushMomentum(double mass, double charge,
+        const ThreeVector &momentum, const ThreeVector &Efield,
+        const ThreeVector &Bfield) const override;
+
+    // Momentum after radiation reaction acts for time dt in constant fields
+    ThreeVector RadiationKick(double mass, const ThreeVector &momentum,
+        const ThreeVector &Efield, const ThreeVector &Bfield, double dt) const;
+
+    ThreeVector RadiationForce(double mass, const ThreeVector &momentum,
+        const ThreeVector &Efield, const ThreeVector &Bfield) const;
+
+    RadiationReaction m_radReaction;
+};
+#endif
@@ -0,0 +1,127 @@
+#include <cmath>
+
+#include "StaticFieldPusher.hh"
+
+namespace
+{
+    /* sinh(x)/x, (cosh(x) - 1)/x^2, (sinh(x) - x)/x^3 and
+       (cosh(x) - 1 - x^2/2)/x^4 for z = x^2, which is negative for imaginary
+       x. Near zero the closed forms cancel so their series are used */
+    void Phi(double z, double* f)
+    {
+        if (std::fabs(z) < 0.25)
+        {
+            f[0] = 1.0 + z / 6.0 * (1.0 + z / 20.0 * (1.0 + z / 42.0
+                * (1.0 + z / 72.0 * (1.0 + z / 110.0))));
+            f[1] = 0.5 * (1.0 + z / 12.0 * (1.0 + z / 30.0 * (1.0 + z / 56.0
+                * (1.0 + z / 90.0 * (1.0 + z / 132.0)))));
+            f[2] = (1.0 + z / 20.0 * (1.0 + z / 42.0 * (1.0 + z / 72.0
+                * (1.0 + z / 110.0 * (1.0 + z / 156.0))))) / 6.0;
+            f[3] = (1.0 + z / 30.0 * (1.0 + z / 56.0 * (1.0 + z / 90.0
+                * (1.0 + z / 132.0 * (1.0 + z / 182.0))))) / 24.0;
+        } else if (z > 0)
+        {
+            double x = std::sqrt(z);
+            double sinhx = std::sinh(x), coshx = std::cosh(x);
+            f[0] = sinhx / x;
+            f[1] = (coshx - 1.0) / z;
+            f[2] = (sinhx - x) / (x * z);
+            f[3] = (coshx - 1.0 - z / 2.0) / (z * z);
+        } else
+        {
+            double y = std::sqrt(-z);
+            double siny = std::sin(y), cosy = std::cos(y);
+            f[0] = siny / y;
+            f[1] = (1.0 - cosy) / -z;
+            f[2] = (y - siny) / (y * -z);
+            f[3] = (cosy - 1.0 - z / 2.0) / (z * z);
+        }
+    }
+
+    /* Coefficients of exp(M tau) = c0 + c1 M + c2 M^2 + c3 M^3 and of its
+       integral from zero, cInt0 + cInt1 M + ..., for M with eigenvalues +-a
+       and +-ib. Written as weighted averages of the a and b parts so they
+       stay accurate as a and b vanish */
+    void Coefficients(double a2, double b2, double tau, double* c,
+        double* cInt)
+    {
+        double t2 = tau * tau;
+        double fa[4], fb[4];
+        Phi(a2 * t2, fa);
+        Phi(-b2 * t2, fb);
+        double wa = a2 + b2 > 0 ? a2 / (a2 + b2) : 0.5;
+        double wb = 1.0 - wa;
+        c[2] = t2 * (wa * fa[1] + wb * fb[1]);
+        c[3] = t2 * tau * (wa * fa[2] + wb * fb[2]);
+        c[0] = 1.0 + a2 * (t2 * fa[1] - c[2]);
+        c[1] = tau * fa[0] - a2 * c[3];
+        cInt[3] = t2 * t2 * (wa * fa[3] + wb * fb[3]);
+        cInt[2] = c[3];
+        cInt[1] = t2 * fa[1] - a2 * cInt[3];
+        cInt[0] = c[1];
+    }
+}
+
+StaticFieldPusher::StaticFieldPusher(StaticEMField* field, double dt):
+ExactPusher(field, dt)
+{
+    field->GetField(0, ThreeVector(0, 0, 0), m_eField, m_bField);
+
+    // a^2 - b^2 = E^2 - B^2 and ab = |E.B|, each root taken in the form
+    // that does not cancel
+    double f = 0.5 * (m_eField.Mag2() - m_bField.Mag2());
+    double g = m_eField.Dot(m_bField);
+    double root = std::sqrt(f * f + g * g);
+    if (f >= 0)
+    {
+        m_a2 = root + f;
+        m_b2 = m_a2 > 0 ? g * g / m_a2 : 0;
+    } else
+    {
+        m_b2 = root - f;
+        m_a2 = g * g / m_b2;
+    }
+}
+
+void StaticFieldPusher::Advance(double mass, double charge, double time,
+    ThreeVector &position, ThreeVector &momentum, double dt) const
+{
+    // Powers of M applied to the four velocity (u0, u), where
+    // M (u0, u) = q/m (E.u, E u0 + u x B)
+    double s = charge / mass;
+    double u0[4];
+    ThreeVector u[4];
+    u0[0] = std::sqrt(1.0 + momentum.Mag2() / (mass * mass));
+    u[0] = momentum / mass;
+    for (unsigned int k = 1; k < 4; k++)
+    {
+        u0[k] = s * m_eField.Dot(u[k-1]);
+        u[k] = s * (u0[k-1] * m_eField + u[k-1].Cross(m_bField));
+    }
+    double a2 = s * s * m_a2, b2 = s * s * m_b2;
+
+    // The lab time grows with the proper time at the rate gamma, which is at
+    // least one, so the proper time of the step is between 0 and dt. Newton
+    // steps that leave the bracket are replaced by bisection
+    double c[4], cInt[4];
+    double low = 0, high = dt, tau = dt / u0[0];
+    for (unsigned int i = 0; i < 100; i++)
+    {
+        Coefficients(a2, b2, tau, c, cInt);
+        double elapsed = cInt[0] * u0[0] + cInt[1] * u0[1] + cInt[2] * u0[2]
+            + cInt[3] * u0[3];
+        double gamma = c[0] * u0[0] + c[1] * u0[1] + c[2] * u0[2]
+            + c[3] * u0[3];
+        if (elapsed < dt) low = tau; else high = tau;
+        double next = tau - (elapsed - dt) / gamma;
+        if (!(next >= low && next <= high)) next = 0.5 * (low + high);
+        bool converged = std::fabs(next - tau) <= 1e-15 * tau;
+        tau = next;
+        if (converged) break;
+    }
+
+    Coefficients(a2, b2, tau, c, cInt);
+    position = position + cInt[0] * u[0] + cInt[1] * u[1] + cInt[2] * u[2]
+        + cInt[3] * u[3];
+    momentum = mass * (c[0] * u[0] + c[1] * u[1] + c[2] * u[2] + c[3] * u[3]);
+}
@@ -0,0 +1,28 @@
+#ifndef STATICFIELDPUSHER_HH
+#define STATICFIELDPUSHER_HH
+
+#include "ExactPusher.hh"
+#include "StaticEMField.hh"
+
+/* Exact motion in a uniform static field. The four velocity rotates as
+   exp(M tau) in proper time tau, where M is the field tensor times the
+   charge over the mass. M has eigenvalues +-a and +-ib, set by the field
+   invariants, so the exponential and its integral, which gives the
+   position, are cubics in M. The proper time of the step is found from the
+   lab time by Newton's method. */
+class StaticFieldPusher: public ExactPusher
+{
+public:
+    StaticFieldPusher(StaticEMField* field, double dt);
+
+protected:
+    void Advance(double mass, double charge, double time,
+        ThreeVector &position, ThreeVector &momentum, double dt) const override;
+
+private:
+    ThreeVector m_eField;
+    ThreeVector m_bField;
+    double m_a2;    // a^2 and b^2 for unit charge over mass
+    double m_b2;
+};
+#endif
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "StepTasks.hh"
+#include "MCTools.hh"
+
+StepTasks::StepTasks(TaskScheduler* scheduler, unsigned int minParticles,
+    unsigned int rangeParticles):
+m_scheduler(scheduler), m_minParticles(minParticles),
+m_rangeParticles(std::max(rangeParticles, 1u))
+{
+}
+
+void StepTasks::ForEachRange(ParticleList* partList,
+    const RangeBody& body) const
+{
+    unsigned int nPart = partList->GetNPart();
+    if (m_scheduler == nullptr || m_minParticles == 0
+        || nPart < m_minParticles)
+    {
+        body(0, nPart);
+        return;
+    }
+
+    // The streams of the ranges are fixed by one draw from the event's
+    PhiloxEngine& engine = MCTools::Engine();
+    std::uint64_t base = static_cast<std::uint64_t>(engine()) << 32;
+    base |= engine();
+
+    unsigned int nRange = (nPart + m_rangeParticles - 1) / m_rangeParticles;
+    std::vector<std::unique_ptr<ParticleList> > staging(nRange);
+    TaskGroup group;
+    for (unsigned int range = 0; range < nRange; range++)
+    {
+        staging[range].reset(new ParticleList(partList->GetName()));
+        ParticleList* stage = staging[range].get();
+        unsigned int begin = range * m_rangeParticles;
+        unsigned int end = std::min(nPart, begin + m_rangeParticles);
+        m_scheduler->Spawn(group, [=, &body]()
+        {
+            // The range may run on a thread that is part way through an
+            // event of its own, so its stream is put back after
+            PhiloxEngine& engine = MCTools::Engine();
+            PhiloxEngine saved = engine;
+            MCTools::SetTaskStream(base, range);
+            {
+                ParticleStaging scope(partList, stage);
+                body(begin, end);
+            }
+            engine = saved;
+        });
+    }
+    m_scheduler->Wait(group);
+
+    for (unsigned int range = 0; range < nRange; range++)
+    {
+        partList->Append(*staging[range]);
+    }
+}
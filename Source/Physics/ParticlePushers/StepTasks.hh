@@ -0,0 +1,35 @@
+#ifndef STEPTASKS_HH
+#define STEPTASKS_HH
+
+#include <functional>
+
+#include "ParticleList.hh"
+#include "TaskScheduler.hh"
+
+/* Splits a step of one large event into tasks over ranges of its particles,
+   which the scheduler hands to idle threads while the event waits. Each
+   range draws from a random stream set by the event's stream and the range,
+   and stages its secondaries in a list of its own. They are appended to the
+   event in range order once all the ranges are done, so the result does not
+   depend on the number of threads. Events with fewer than minParticles
+   particles, or all events if it is 0, are stepped in one range on the
+   calling thread. The scheduler is not owned. */
+class StepTasks
+{
+public:
+    typedef std::function<void(unsigned int, unsigned int)> RangeBody;
+
+    StepTasks(TaskScheduler* scheduler, unsigned int minParticles = 8192,
+        unsigned int rangeParticles = 1024);
+
+    // Calls body(begin, end) for ranges covering the particles in the list
+    void ForEachRange(ParticleList* partList, const RangeBody& body) const;
+
+    unsigned int GetMinParticles() const {return m_minParticles;}
+
+private:
+    TaskScheduler* m_scheduler;
+    unsigned int m_minParticles;    // Smallest event that is split
+    unsigned int m_rangeParticles;  // Particles in each task
+};
+#endif
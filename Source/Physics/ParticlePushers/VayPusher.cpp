@@ -0,0 +1,31 @@
+#include <cmath>
+
+#include "VayPusher.hh"
+
+VayPusher::VayPusher(EMField* field, double dt,
+    RadiationReaction radReaction):
+SplitStepPusher(field, dt, radReaction)
+{
+}
+
+ThreeVector VayPusher::Rotate(double mass, double charge,
+    const ThreeVector &momentum, const ThreeVector &Efield,
+    const ThreeVector &Bfield, double dt) const
+{
+    // Works with u = p / m
+    double epsilon = charge * dt / (2.0 * mass);
+    ThreeVector u = momentum / mass;
+    double gamma = std::sqrt(1.0 + u.Mag2());
+    ThreeVector uHalf = u + epsilon * (Efield + (u / gamma).Cross(Bfield));
+    ThreeVector uPrime = uHalf + epsilon * Efield;
+    ThreeVector tau = epsilon * Bfield;
+    double uStar = uPrime.Dot(tau);
+    double tau2 = tau.Mag2();
+    double sigma = 1.0 + uPrime.Mag2() - tau2;
+    double gammaNew = std::sqrt(0.5 * (sigma + std::sqrt(sigma * sigma
+        + 4.0 * (tau2 + uStar * uStar))));
+    ThreeVector t = tau / gammaNew;
+    double s = 1.0 / (1.0 + t.Mag2());
+    ThreeVector uNew = s * (uPrime + uPrime.Dot(t) * t + uPrime.Cross(t));
+    return mass * uNew;
+}
@@ -0,0 +1,19 @@
+#ifndef VAYPUSHER_HH
+#define VAYPUSHER_HH
+
+#include "SplitStepPusher.hh"
+
+/* Vay (2008) scheme, which gets the drift in crossed E and B fields
+   right at large gamma, where Boris does not */
+class VayPusher: public SplitStepPusher
+{
+public:
+    VayPusher(EMField* field, double dt,
+        RadiationReaction radReaction = RadiationReaction::None);
+
+protected:
+    ThreeVector Rotate(double mass, double charge, const ThreeVector &momentum,
+        const ThreeVector &Efield, const ThreeVector &Bfield,
+        double dt) const override;
+};
+#endif
@@ -2,8 +2,6 @@
 #include <fstream>
 
 #include "ContinuousEmission.hh"
-#include "Photon.hh"
-#include "Numerics.hh"
 #include "MCTools.hh"
 #include "UnitsSystem.hh"
 
@@ -18,47 +16,52 @@ ContinuousEmission::~ContinuousEmission()
 {
 }
 
-void ContinuousEmission::Interact(Particle *part, ParticleList *partList) const
+void ContinuousEmission::Interact(ParticleList* partList, unsigned int index,
+    double dt) const
 {
     // Check for alive lepton
-    if (part->GetMass() == 0 || part->IsAlive() == false) return;
+    if (partList->GetSpecies(index) == Species::Photon
+        || partList->IsAlive(index) == false) return;
 
     // prevent from occuring every time step
     if (MCTools::RandDouble(0, 1) > m_sampleFrac) return;
 
-    double eta = CalculateEta(part);
+    double eta = CalculateEta(partList, index);
 
     // Check for very small values of eta / classical
-    double logh, chi;
+    double chi;
     if (eta < 1.0e-12 || m_classical)
     {
-        logh = 0.7193;
-        double chiMin = std::exp(m_h_etaAxis[0]);
+        double chiMin = std::exp(m_tables->h.GetAxis()[0]);
         // Extrapolate table for classical (stolen from Chris Arran).
         chi = CalculateChi(chiMin) * (eta / chiMin)  * (eta / chiMin);
     } else
     {
-
-        logh = Numerics::Interpolate1D(m_h_etaAxis, m_h_dataTable,
-            m_h_length, std::log10(eta));
         chi = CalculateChi(eta);
     }
 
     // Calculate photon weight
-    double deltaOD = m_dt * std::sqrt(3) * UnitsSystem::alpha * eta
-        * std::pow(10.0, logh)
-        / (part->GetGamma() * 2.0 * UnitsSystem::pi);
-    double weight = part->GetWeight() * deltaOD / m_sampleFrac;
+    double deltaOD = PhotonNumber(eta, partList->GetGamma(index), dt,
+        m_classical);
+    double weight = partList->GetWeight(index) * deltaOD / m_sampleFrac;
 
     // Calculate photon energy
-    double gammaE = 2.0 * chi * part->GetGamma() / eta;
-    ThreeVector gammaP = gammaE * part->GetDirection();
+    double gammaE = 2.0 * chi * partList->GetGamma(index) / eta;
+    ThreeVector gammaP = gammaE * partList->GetDirection(index);
 
     // Add new partles to the simulation
     if (gammaE > m_eMin)
     {
-        Photon* photon = new Photon(gammaE, part->GetPosition(), 
-            part->GetDirection(), weight, part->GetTime(), m_track);
-        partList->AddParticle(photon);
+        partList->AddParticle(Species::Photon, partList->GetPosition(index),
+            gammaP, weight, partList->GetTime(index), m_track);
     }
-}
\ No newline at end of file
+}
+
+double ContinuousEmission::OpticalDepthChange(ParticleList* partList,
+    unsigned int index, double dt) const
+{
+    if (partList->GetSpecies(index) == Species::Photon
+        || partList->IsAlive(index) == false) return 0;
+    return PhotonNumber(CalculateEta(partList, index), partList->GetGamma(index),
+        dt, m_classical);
+}
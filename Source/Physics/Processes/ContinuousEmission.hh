@@ -11,7 +11,14 @@ public:
     
     virtual ~ContinuousEmission();
 
-    void Interact(Particle* part, ParticleList *partList) const override;
+    using Process::Interact;
+
+    void Interact(ParticleList* partList, unsigned int index,
+        double dt) const override;
+
+    // Expected number of photons emitted over dt
+    double OpticalDepthChange(ParticleList* partList, unsigned int index,
+        double dt) const override;
 
 private:
     bool m_classical;
@@ -3,9 +3,9 @@
 
 #include "Process.hh"
 #include "EMField.hh"
-#include "Lepton.hh"
 #include "ParticleList.hh"
 #include "UnitsSystem.hh"
+#include "QEDTables.hh"
 
 class DeterministicEmission: public Process
 {
@@ -17,35 +17,25 @@ public:
 
     // Main function carrying out the process. The particle is the iunterafting 
     // particle and the particle list is where the new particle will be added.
-    void Interact(Particle* part, ParticleList *partList) const override;
+    using Process::Interact;
+
+    void Interact(ParticleList* partList, unsigned int index,
+        double dt) const override;
 
 private:
     
     // Calculates the value of eta at the particles current location
-    double CalculateEta(Particle* part) const;
+    double CalculateEta(ParticleList* partList, unsigned int index) const;
 
     double CalculateH(double eta) const;
 
     double CalculateChi(double eta) const;  // Very bad method at the moment
 
-    void LoadTables();
-
-    void UnloadTables();
-
 private:
     // Minimum energy of tracked photon
     double m_eMin;
 
-    // Data tables for h factor
-    double* m_h_dataTable;
-    double* m_h_etaAxis;
-    unsigned int m_h_length;
-
-    // Data tables used for calculating the photon energy
-    double** m_phEn_dataTable;
-    double** m_phEn_chiAxis;
-    double* m_phEn_chiMinAxis;
-    double* m_phEn_etaAxis;
-    unsigned int m_phEn_etaLength, m_phEn_chiLength;
+    // Tables for h and the photon energy, shared between all processes
+    std::shared_ptr<const QEDTables::EmissionTables> m_tables;
 };
 #endif
@@ -1,157 +1,237 @@
-#include <fstream>
+#include <algorithm>
+#include <limits>
 
 #include "NonLinearBreitWheeler.hh"
-#include "Lepton.hh"
-#include "Numerics.hh"
 #include "UnitsSystem.hh"
 #include "MCTools.hh"
 
 NonLinearBreitWheeler::NonLinearBreitWheeler(EMField* field, double dt, bool track):
 Process(field, dt, track)
 {
-    LoadTables();
+    m_tables = QEDTables::PairProduction();
+
+    unsigned int size = m_tables->t.GetAxis().Size();
+    const double* logT = m_tables->t.GetData();
+    double maxLogT = logT[0];
+    m_maxT.resize(size);
+    for (unsigned int i = 0; i < size; i++)
+    {
+        maxLogT = std::fmax(maxLogT, logT[i]);
+        m_maxT[i] = std::pow(10.0, maxLogT);
+    }
 }
 
 NonLinearBreitWheeler::~NonLinearBreitWheeler()
 {
-    UnloadTables();
 }
 
-void NonLinearBreitWheeler::Interact(Particle *part, ParticleList *partList) const
+void NonLinearBreitWheeler::Interact(ParticleList* partList, unsigned int index,
+    double dt) const
 {
-    if (part->GetType() != "Photon" || part->IsAlive() == false) return;
-
-    double chi = CalculateChi(part);
-    double logt = Numerics::Interpolate1D(m_t_chiAxis, m_t_dataTable,
-        m_t_length, std::log10(chi));
-    double deltaOD = m_dt * UnitsSystem::alpha * chi * std::pow(10.0, logt)
-        / part->GetEnergy();
-    part->UpdateOpticalDepth(deltaOD);
-
-    // Now check if process hass occured. If so then emmit and react
-    if (part->GetOpticalDepth() < 0.0)
+    if (partList->GetSpecies(index) != Species::Photon
+        || partList->IsAlive(index) == false) return;
+
+    // Thinned as for photon emission, the optical depth runs down at an upper
+    // bound of the rate and a pair is accepted with the ratio of the rate to
+    // the bound
+    double bound = PairNumberBound(StrengthBound(partList, index),
+        partList->GetEnergy(index), dt);
+    partList->UpdateOpticalDepth(index, bound);
+    if (partList->GetOpticalDepth(index) >= 0.0) return;
+    double chi = CalculateChi(partList, index);
+    double number = PairNumber(chi, partList->GetEnergy(index), dt);
+    if (NextCandidate(partList, index, number, bound))
     {
         double split = CalculateSplit(chi);
-        double pEnergy = split * part->GetEnergy();
-        double eEnergy = (1.0 - split) * part->GetEnergy();
-        ThreeVector pMomentum =  std::sqrt(pEnergy * pEnergy - 1.0) * part->GetDirection();
-        ThreeVector eMomentum =  std::sqrt(eEnergy * eEnergy - 1.0) * part->GetDirection();
-        Lepton* positron = new Lepton(1.0, 1.0, part->GetPosition(), pMomentum,
-            part->GetWeight(), part->GetTime(), m_track); 
-        Lepton* electron = new Lepton(1.0, -1.0, part->GetPosition(), eMomentum, 
-            part->GetWeight(), part->GetTime(), m_track);
-        partList->AddParticle(positron);
-        partList->AddParticle(electron);
-        part->Kill();
+        double pEnergy = split * partList->GetEnergy(index);
+        double eEnergy = (1.0 - split) * partList->GetEnergy(index);
+        ThreeVector partDir = partList->GetDirection(index);
+        ThreeVector position = partList->GetPosition(index);
+        double weight = partList->GetWeight(index);
+        double time = partList->GetTime(index);
+        ThreeVector pMomentum =  std::sqrt(pEnergy * pEnergy - 1.0) * partDir;
+        ThreeVector eMomentum =  std::sqrt(eEnergy * eEnergy - 1.0) * partDir;
+        partList->AddParticle(Species::Positron, position, pMomentum, weight,
+            time, m_track);
+        partList->AddParticle(Species::Electron, position, eMomentum, weight,
+            time, m_track);
+        partList->Kill(index);
     }
 }
 
-double NonLinearBreitWheeler::CalculateSplit(double chi) const
+double NonLinearBreitWheeler::OpticalDepthChange(ParticleList* partList,
+    unsigned int index, double dt) const
 {
-    double rand = MCTools::RandDouble(0, 1);
-    int lowIndex;
-    double frac;
-    Numerics::ClosestPoints(m_eFract_chiAxis, m_efract_length, std::log10(chi),
-        lowIndex, frac);
-    double lowValue = Numerics::Interpolate1D(m_eFract_dataTable[lowIndex],
-        m_eFract_fractAxis, m_efract_length, rand);
-    double highValue = Numerics::Interpolate1D(m_eFract_dataTable[lowIndex+1],
-        m_eFract_fractAxis, m_efract_length, rand);
-    return (1.0 - frac) * lowValue + frac * highValue;
+    if (partList->GetSpecies(index) != Species::Photon
+        || partList->IsAlive(index) == false) return 0;
+    return PairNumber(CalculateChi(partList, index), partList->GetEnergy(index),
+        dt);
 }
 
-double NonLinearBreitWheeler::CalculateChi(Particle* part) const
+double NonLinearBreitWheeler::PairNumber(double chi, double energy,
+    double dt) const
 {
-    ThreeVector partDir = part->GetDirection();
-    ThreeVector eField, bField;
-    m_field->GetField(part->GetTime(), part->GetPosition(), eField, bField);
-    ThreeVector ePara = eField.Dot(partDir) * partDir;
-    ThreeVector ePerp = eField - ePara;
-    return 0.5 * part->GetEnergy() * (ePerp + partDir.Cross(bField)).Mag();
+    double logt = m_tables->t.Interpolate(std::log10(chi));
+    return dt * UnitsSystem::alpha * chi * std::pow(10.0, logt) / energy;
 }
 
-void NonLinearBreitWheeler::LoadTables()
+double NonLinearBreitWheeler::DecayTime(const ParticleList* partList,
+    unsigned int index, double timeEnd) const
 {
-    char* tablePath(getenv("QED_TABLES_PATH"));
-    if (tablePath == NULL)
+    double never = std::numeric_limits<double>::infinity();
+    double time = partList->GetTime(index);
+    double energy = partList->GetEnergy(index);
+    double depth = partList->GetOpticalDepth(index);
+    ThreeVector start = partList->GetPosition(index);
+    ThreeVector direction = partList->GetDirection(index);
+
+    // Most photons are too soft to ever decay in the strongest field
+    double maxRate = PairNumberBound(m_field->MaxStrength(), energy, 1.0);
+    if (!(maxRate * (timeEnd - time) >= depth)) return never;
+
+    /* Adaptive Simpson's rule along the path. A panel is halved while
+       Simpson's rule and the trapezium rule disagree by more than the
+       tolerance, down to a 64th of the step, and grows again, up to 16 steps,
+       where they agree. Stretches outside the field are skipped */
+    double maxWidth = 16.0 * m_dt, minWidth = m_dt / 64.0;
+    double width = m_dt;
+    double low = time;
+    double rateLow = RayRate(low, start, direction, energy);
+    while (low < timeEnd)
     {
-        std::cout << "Error: Enviromental variable \"QED_TABLES_PATH\" "; 
-        std::cout << "is not set!" << std::endl;
-        std::cout <<  "Please set QED_TABLES_PATH to point to tables directory." << std::endl;
-    }
+        ThreeVector position = start + (low - time) * direction;
+        if (m_field->InSupport(low, position) == false)
+        {
+            double entry = m_field->EntryTime(low, position, direction);
+            if (!(entry < timeEnd)) return never;
+            if (entry > low)
+            {
+                low = entry;
+                rateLow = RayRate(low, start + (low - time) * direction,
+                    direction, energy);
+            }
+        }
+        if (!(maxRate * (timeEnd - low) >= depth)) return never;
+
+        double high = std::min(low + width, timeEnd);
+        double panel = high - low;
+        double rateMid = RayRate(low + panel / 2.0,
+            start + (low + panel / 2.0 - time) * direction, direction, energy);
+        double rateHigh = RayRate(high, start + (high - time) * direction,
+            direction, energy);
+        double simpson = panel * (rateLow + 4.0 * rateMid + rateHigh) / 6.0;
+        double error = std::fabs(simpson - panel * (rateLow + rateHigh) / 2.0);
+        double tolerance = 1e-3 * simpson + 1e-4 * panel / m_dt;
+        if (error > tolerance && panel > minWidth)
+        {
+            width = panel / 2.0;
+            continue;
+        }
 
-    std::string path(tablePath);
-    std::ifstream tFile(path + "/pairprod.table");
-    if (!tFile)
-    {
-        std::cerr << "ERROR: Data table for T not found!" << std::endl;
-        std::cerr << "No file at: " << path + "/pairprod.table" << std::endl;
-        exit(1);
+        if (simpson >= depth)
+        {
+            // The rate is quadratic across the panel, a + b s + c s^2, so its
+            // integral is a cubic increasing from zero to simpson. Bisected
+            // for where it reaches the optical depth
+            double a = rateLow;
+            double b = (-3.0 * rateLow + 4.0 * rateMid - rateHigh) / panel;
+            double c = 2.0 * (rateLow - 2.0 * rateMid + rateHigh)
+                / (panel * panel);
+            double below = 0, above = panel;
+            for (unsigned int i = 0; i < 50; i++)
+            {
+                double s = (below + above) / 2.0;
+                double integral = s * (a + s * (b / 2.0 + s * c / 3.0));
+                if (integral < depth) below = s; else above = s;
+            }
+            return low + (below + above) / 2.0;
+        }
+        depth -= simpson;
+        low = high;
+        rateLow = rateHigh;
+        if (error < tolerance / 4.0) width = std::min(2.0 * panel, maxWidth);
     }
+    return never;
+}
 
-    std::ifstream fractFile(path + "/e_split.table");
-    if (!fractFile)
-    {
-        std::cerr << "ERROR: Data table for pair energy split not found!" << std::endl;
-        std::cerr << "No file at: " << path + "/e_split.table" << std::endl;
-        exit(1);
-    }
+void NonLinearBreitWheeler::Decay(ParticleList* partList, unsigned int index,
+    double decayTime, double time) const
+{
+    double energy = partList->GetEnergy(index);
+    ThreeVector partDir = partList->GetDirection(index);
+    ThreeVector position = partList->GetPosition(index)
+        + (decayTime - partList->GetTime(index)) * partDir;
+    ThreeVector eField, bField;
+    m_field->GetField(decayTime, position, eField, bField);
+    double chi = Chi(energy, partDir, eField, bField);
+
+    double split = CalculateSplit(chi);
+    double pEnergy = split * energy;
+    double eEnergy = (1.0 - split) * energy;
+    double weight = partList->GetWeight(index);
+    ThreeVector pMomentum =  std::sqrt(pEnergy * pEnergy - 1.0) * partDir;
+    ThreeVector eMomentum =  std::sqrt(eEnergy * eEnergy - 1.0) * partDir;
+    partList->AddParticle(Species::Positron, position
+        + ((time - decayTime) / pEnergy) * pMomentum, pMomentum, weight, time,
+        m_track);
+    partList->AddParticle(Species::Electron, position
+        + ((time - decayTime) / eEnergy) * eMomentum, eMomentum, weight, time,
+        m_track);
+    partList->Kill(index);
+}
 
-    std::ifstream epsilonFile(path + "/epsilon.table");
-    if (!epsilonFile)
-    {
-        std::cerr << "ERROR: Data table for epsilon split not found!" << std::endl;
-        std::cerr << "No file at: " << path + "/ epsilon.table" << std::endl;
-        exit(1);
-    }
+double NonLinearBreitWheeler::RayRate(double time, const ThreeVector &position,
+    const ThreeVector &direction, double energy) const
+{
+    ThreeVector eField, bField;
+    m_field->GetField(time, position, eField, bField);
+    double chi = Chi(energy, direction, eField, bField);
+    return chi > 0 ? PairNumber(chi, energy, 1.0) : 0.0;
+}
 
-    std::ifstream chiFile(path + "/log_chi.table");
-    if (!chiFile)
-    {
-        std::cerr << "ERROR: Data table for log chi not found!" << std::endl;
-        std::cerr << "No file at: " << path + "/ log_chi.table" << std::endl;
-        exit(1);
-    }
+double NonLinearBreitWheeler::PairNumberBound(double strength, double energy,
+    double dt) const
+{
+    return dt * UnitsSystem::alpha * 0.5 * strength
+        * MaxT(0.5 * energy * strength);
+}
 
-    tFile >> m_t_length;
-    m_t_chiAxis = new double [m_t_length];
-    m_t_dataTable = new double [m_t_length];
-    
-    double logChi, logTable;
-    for (unsigned int i = 0; i < m_t_length; i++)
-    {
-        tFile >> logChi >> logTable;
-        m_t_chiAxis[i]   = logChi;
-        m_t_dataTable[i] = logTable;
-    }
+double NonLinearBreitWheeler::MaxT(double chi) const
+{
+    // T is interpolated linearly in log between the table points, so up to
+    // chi it is no larger than the largest value up to the point above chi.
+    // The table is flat below its range and falls off above it
+    const TableAxis& axis = m_tables->t.GetAxis();
+    unsigned int i = std::min(axis.Interval(std::log10(chi)) + 1,
+        axis.Size() - 1);
+    return m_maxT[i];
+}
 
-    fractFile >> m_efract_length;
-    m_eFract_chiAxis = new double [m_efract_length];
-    m_eFract_fractAxis = new double [m_efract_length];
-    m_eFract_dataTable = new double* [m_efract_length];
-    
-    for (unsigned int i = 0; i < m_efract_length; i++)
-    {
-        chiFile >> logChi;
-        m_eFract_chiAxis[i] = logChi;
-        epsilonFile >> m_eFract_fractAxis[i];
-        m_eFract_dataTable[i] = new double [m_efract_length];
-        for (unsigned int j = 0; j < m_efract_length; j++)
-        {
-            fractFile >> m_eFract_dataTable[i][j];
-        }
-    }
+double NonLinearBreitWheeler::CalculateSplit(double chi) const
+{
+    return m_tables->split.Sample(std::log10(chi), MCTools::RandDouble(0, 1));
 }
 
-void NonLinearBreitWheeler::UnloadTables()
+double NonLinearBreitWheeler::CalculateChi(ParticleList* partList,
+    unsigned int index) const
 {
-    delete [] m_t_dataTable;
-    delete [] m_t_chiAxis;
-    delete [] m_eFract_chiAxis;
-    delete [] m_eFract_fractAxis;
-    for (unsigned int i = 0; i < m_efract_length; i++)
+    if (partList->HasQuantumParameter(index))
     {
-        delete [] m_eFract_dataTable[i];
+        return partList->GetQuantumParameter(index);
     }
-    delete [] m_eFract_dataTable;
-}
\ No newline at end of file
+    ThreeVector eField, bField;
+    m_field->GetParticleField(partList, index, eField, bField);
+    double chi = Chi(partList->GetEnergy(index), partList->GetDirection(index),
+        eField, bField);
+    partList->SetQuantumParameter(index, chi);
+    return chi;
+}
+
+double NonLinearBreitWheeler::Chi(double energy, const ThreeVector &direction,
+    const ThreeVector &eField, const ThreeVector &bField)
+{
+    ThreeVector ePara = eField.Dot(direction) * direction;
+    ThreeVector ePerp = eField - ePara;
+    return 0.5 * energy * (ePerp + direction.Cross(bField)).Mag();
+}
+
@@ -1,8 +1,11 @@
 #ifndef NONLINEARBREITWHEELER_HH
 #define NONLINEARBREITWHEELER_HH
 
+#include <vector>
+
 #include "Process.hh"
-#include "Photon.hh"
+#include "ParticleList.hh"
+#include "QEDTables.hh"
 
 class NonLinearBreitWheeler: public Process 
 {
@@ -11,27 +14,53 @@ public:
 
     virtual ~NonLinearBreitWheeler();
 
-    void Interact(Particle* part, ParticleList *partList) const override;
+    using Process::Interact;
+
+    void Interact(ParticleList* partList, unsigned int index,
+        double dt) const override;
+
+    double OpticalDepthChange(ParticleList* partList, unsigned int index,
+        double dt) const override;
+
+    /* Time at which the photon at index decays going straight on from where
+       it is, when the pair number integrated along its path reaches its
+       optical depth. Infinite if that is after timeEnd */
+    double DecayTime(const ParticleList* partList, unsigned int index,
+        double timeEnd) const;
+
+    // Replaces the photon at index by a pair produced where it is at
+    // decayTime, moved on in a straight line to time
+    void Decay(ParticleList* partList, unsigned int index, double decayTime,
+        double time) const;
 
 private:
 
-    double CalculateChi(Particle* part) const;
+    double CalculateChi(ParticleList* partList, unsigned int index) const;
+
+    // Chi of a photon of this energy and direction in the fields
+    static double Chi(double energy, const ThreeVector &direction,
+        const ThreeVector &eField, const ThreeVector &bField);
+
+    // Pair number per unit time of a photon at position at time
+    double RayRate(double time, const ThreeVector &position,
+        const ThreeVector &direction, double energy) const;
 
     double CalculateSplit(double chi) const;
 
-    void LoadTables();
+    // Expected number of pairs produced over dt by a photon of this energy
+    double PairNumber(double chi, double energy, double dt) const;
+
+    // Upper bound on PairNumber for a photon of this energy in a field of
+    // strength |E| + |B|, as chi is at most half the energy times the strength
+    double PairNumberBound(double strength, double energy, double dt) const;
 
-    void UnloadTables();
+    // Largest T for any chi up to chi
+    double MaxT(double chi) const;
 
 private:
-    // Data for t tables
-    double* m_t_dataTable;
-    double* m_t_chiAxis;
-    unsigned int m_t_length;
-
-    double** m_eFract_dataTable;
-    double* m_eFract_chiAxis;
-    double* m_eFract_fractAxis;
-    unsigned int m_efract_length;
+    // Tables for T and the pair energy split, shared between all processes
+    std::shared_ptr<const QEDTables::PairTables> m_tables;
+    // Largest T up to each point of the T table
+    std::vector<double> m_maxT;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "PhotonDecay.hh"
+
+PhotonDecay::PhotonDecay(const NonLinearBreitWheeler* process,
+    double timeEnd):
+m_process(process), m_timeEnd(timeEnd), m_nSeen(0)
+{
+}
+
+void PhotonDecay::Update(ParticleList* partList, double time)
+{
+    unsigned int nPart = partList->GetNPart();
+    for (; m_nSeen < nPart; m_nSeen++)
+    {
+        if (partList->GetSpecies(m_nSeen) != Species::Photon
+            || partList->IsAlive(m_nSeen) == false) continue;
+        double decayTime = m_process->DecayTime(partList, m_nSeen, m_timeEnd);
+        if (decayTime <= m_timeEnd)
+        {
+            m_scheduled.push(Decay(decayTime, m_nSeen));
+        }
+    }
+
+    while (!m_scheduled.empty() && m_scheduled.top().first <= time)
+    {
+        Decay decay = m_scheduled.top();
+        m_scheduled.pop();
+        if (partList->IsAlive(decay.second) == false) continue;
+        m_process->Decay(partList, decay.second, decay.first, time);
+    }
+}
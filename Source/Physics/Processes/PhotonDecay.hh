@@ -0,0 +1,39 @@
+#ifndef PHOTONDECAY_HH
+#define PHOTONDECAY_HH
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "NonLinearBreitWheeler.hh"
+#include "ParticleList.hh"
+
+/* Breit-Wheeler pair production for the photons of one event without
+   stepping them. Photons go straight, so when one is first seen the time it
+   decays is found by integrating its pair number along its path, and it is
+   not looked at again unless that is before timeEnd. Used in place of the
+   process in the step loop. The process is not owned. */
+class PhotonDecay
+{
+public:
+    PhotonDecay(const NonLinearBreitWheeler* process, double timeEnd);
+
+    /* Finds when the photons added to the list since the last update decay
+       and decays those due by time, with their pairs moved on to time. Pairs
+       are added to the list and wait for the next step */
+    void Update(ParticleList* partList, double time);
+
+    // Photons waiting to decay
+    unsigned int GetNScheduled() const {return m_scheduled.size();}
+
+private:
+    typedef std::pair<double, unsigned int> Decay;   // time and index
+
+    const NonLinearBreitWheeler* m_process;
+    double m_timeEnd;
+    unsigned int m_nSeen;       // Particles of the list already looked at
+    std::priority_queue<Decay, std::vector<Decay>, std::greater<Decay> >
+        m_scheduled;            // Earliest first
+};
+#endif
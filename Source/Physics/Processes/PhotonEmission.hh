@@ -3,9 +3,9 @@
 
 #include "Process.hh"
 #include "EMField.hh"
-#include "Lepton.hh"
 #include "ParticleList.hh"
 #include "UnitsSystem.hh"
+#include "QEDTables.hh"
 
 class PhotonEmission: public Process
 {
@@ -15,35 +15,36 @@ public:
     
     virtual ~PhotonEmission();
 
-    virtual void Interact(Particle *part, ParticleList *partList) const = 0;
+    using Process::Interact;
+
+    virtual void Interact(ParticleList* partList, unsigned int index,
+        double dt) const = 0;
 
 protected:
     
-    double CalculateEta(Particle* part) const;
+    double CalculateEta(ParticleList* partList, unsigned int index) const;
 
     double CalculateH(double eta) const;
 
     double CalculateChi(double eta) const;
 
-    void LoadTables();
+    // Expected number of photons a lepton emits over dt, the optical depth
+    // it uses up. The classical rate is used for small eta or if classical
+    double PhotonNumber(double eta, double gamma, double dt,
+        bool classical = false) const;
 
-    void UnloadTables();
+    // Upper bound on PhotonNumber for any lepton in a field of strength
+    // |E| + |B|, as eta is at most gamma times the strength
+    double PhotonNumberBound(double strength, double dt) const;
 
     // Fraction of photons emitted
     double m_sampleFrac;
     // Minimum energy of tracked photon
     double m_eMin;
 
-    // Data tables for h factor
-    double* m_h_dataTable;
-    double* m_h_etaAxis;
-    unsigned int m_h_length;
-
-    // Data tables used for calculating the photon energy
-    double** m_phEn_dataTable;
-    double** m_phEn_chiAxis;
-    double* m_phEn_chiMinAxis;  
-    double* m_phEn_etaAxis;
-    unsigned int m_phEn_etaLength, m_phEn_chiLength;
+    // Tables for h and the photon energy, shared between all processes
+    std::shared_ptr<const QEDTables::EmissionTables> m_tables;
+    // Largest h, at small eta
+    double m_maxH;
 };
 #endif
\ No newline at end of file
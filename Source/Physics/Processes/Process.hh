@@ -1,9 +1,11 @@
 #ifndef PROCESS_HH
 #define PROCESS_HH
 
-#include "Particle.hh"
+#include <limits>
+
 #include "ParticleList.hh"
 #include "EMField.hh"
+#include "MCTools.hh"
 
 class Process
 {
@@ -12,9 +14,61 @@ public:
     
     virtual ~Process(){ };
 
-    virtual void Interact(Particle *part, ParticleList *partList) const = 0;
+    // Applies the process to the particle at index, secondaries are appended
+    void Interact(ParticleList* partList, unsigned int index) const
+    {
+        Interact(partList, index, m_dt);
+    }
+
+    // Applies the process over a time step of dt rather than the process's
+    // own, for particles taking their own time step
+    virtual void Interact(ParticleList* partList, unsigned int index,
+        double dt) const = 0;
+
+    // Optical depth the particle at index would use up over a time dt, the
+    // expected number of events. Zero if the process does not act on it
+    virtual double OpticalDepthChange(ParticleList* partList,
+        unsigned int index, double dt) const {return 0;}
+
+    double GetTimeStep() const {return m_dt;}
 
 protected:
+    /* Upper bound on |E| + |B| at the particle for thinning. Its cached fields
+       if it has them, otherwise the bound of the whole field, so the fields
+       are only evaluated if the field has no bound */
+    double StrengthBound(ParticleList* partList, unsigned int index) const
+    {
+        if (partList->HasField(index) == false)
+        {
+            double strength = m_field->MaxStrength();
+            if (strength < std::numeric_limits<double>::infinity())
+            {
+                return strength;
+            }
+        }
+        ThreeVector eField, bField;
+        m_field->GetParticleField(partList, index, eField, bField);
+        return eField.Mag() + bField.Mag();
+    }
+
+    /* Thinning for a particle whose optical depth, run down at the bound of
+       the rate, has run out. Tests the candidates in this step one at a time,
+       each accepted with probability number / bound, and returns true at the
+       first accepted. The optical depth is left at the next candidate */
+    static bool NextCandidate(ParticleList* partList, unsigned int index,
+        double number, double bound)
+    {
+        while (partList->GetOpticalDepth(index) < 0.0)
+        {
+            // The overshoot past this candidate counts towards the next
+            double overshoot = partList->GetOpticalDepth(index);
+            partList->InitOpticalDepth(index);
+            partList->UpdateOpticalDepth(index, -overshoot);
+            if (number > MCTools::RandDouble(0, 1) * bound) return true;
+        }
+        return false;
+    }
+
     EMField* m_field;
     double m_dt;
     bool m_track;
@@ -0,0 +1,225 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+#include "QEDTables.hh"
+
+namespace
+{
+    void OpenTable(std::ifstream& file, const std::string& path,
+        const std::string& name, const std::string& description)
+    {
+        file.open((path + "/" + name).c_str());
+        if (!file)
+        {
+            std::cerr << "ERROR: Data table for " << description
+                      << " not found!" << std::endl;
+            std::cerr << "No file at: " << path + "/" + name << std::endl;
+            exit(1);
+        }
+    }
+
+    // Registry of the loaded tables for each tables directory
+    struct TableSet
+    {
+        std::weak_ptr<const TableFile> file;
+        std::weak_ptr<const QEDTables::EmissionTables> emission;
+        std::weak_ptr<const QEDTables::PairTables> pair;
+    };
+
+    std::mutex registryMutex;
+    std::map<std::string, TableSet> registry;
+
+    // Must be called with the registry locked
+    std::shared_ptr<const TableFile> LoadFile(const std::string& path)
+    {
+        std::shared_ptr<const TableFile> file = registry[path].file.lock();
+        if (!file)
+        {
+            std::shared_ptr<TableFile> tables = std::make_shared<TableFile>();
+            if (!tables->Open(path + "/" + QEDTables::binaryName))
+            {
+                QEDTables::ReadText(path, *tables);
+            }
+            file = tables;
+            registry[path].file = file;
+        }
+        return file;
+    }
+}
+
+std::string QEDTables::TablePath()
+{
+    char* tablePath(getenv("QED_TABLES_PATH"));
+    if (tablePath == NULL)
+    {
+        std::cout << "Error: Enviromental variable \"QED_TABLES_PATH\" ";
+        std::cout << "is not set!" << std::endl;
+        std::cout <<  "Please set QED_TABLES_PATH to point to tables directory."
+                  << std::endl;
+        exit(1);
+    }
+    return std::string(tablePath);
+}
+
+std::shared_ptr<const TableFile> QEDTables::Load()
+{
+    std::string path = TablePath();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return LoadFile(path);
+}
+
+std::shared_ptr<const QEDTables::EmissionTables> QEDTables::Emission()
+{
+    std::string path = TablePath();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::shared_ptr<const EmissionTables> shared = registry[path].emission.lock();
+    if (shared) return shared;
+
+    // The h table views the arrays, which it keeps alive
+    std::shared_ptr<const TableFile> file = LoadFile(path);
+    std::shared_ptr<EmissionTables> tables = std::make_shared<EmissionTables>();
+    unsigned int rows, cols;
+
+    const double* hEtaAxis = file->Get("h.log_eta", rows, cols);
+    const double* hData = file->Get("h.log_h", rows, cols);
+    tables->h = Table1D(hEtaAxis, hData, cols, file);
+
+    std::vector<Table1D> cdfRows;
+    CDFRows(*file, "photon_energy.cdf", "photon_energy.log_chi", cdfRows);
+    const double* etaRange = file->Get("photon_energy.log_eta_range", rows,
+        cols);
+    TableAxis etaAxis(etaRange[0], etaRange[1], cdfRows.size());
+    tables->photonEnergy = SamplingTable(etaAxis, cdfRows, samplingPoints,
+        samplingTailPoints, samplingTailProb);
+
+    registry[path].emission = tables;
+    return tables;
+}
+
+std::shared_ptr<const QEDTables::PairTables> QEDTables::PairProduction()
+{
+    std::string path = TablePath();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::shared_ptr<const PairTables> shared = registry[path].pair.lock();
+    if (shared) return shared;
+
+    std::shared_ptr<const TableFile> file = LoadFile(path);
+    std::shared_ptr<PairTables> tables = std::make_shared<PairTables>();
+    unsigned int rows, cols;
+
+    const double* tChiAxis = file->Get("pair.log_chi", rows, cols);
+    const double* tData = file->Get("pair.log_t", rows, cols);
+    tables->t = Table1D(tChiAxis, tData, cols, file);
+
+    std::vector<Table1D> cdfRows;
+    CDFRows(*file, "pair_split.cdf", "pair_split.fraction", cdfRows);
+    const double* chiAxis = file->Get("pair_split.log_chi", rows, cols);
+    TableAxis splitAxis(chiAxis, cols);
+    tables->split = SamplingTable(splitAxis, cdfRows, samplingPoints,
+        samplingTailPoints, samplingTailProb);
+
+    registry[path].pair = tables;
+    return tables;
+}
+
+void QEDTables::CDFRows(const TableFile& file, const std::string& cdfName,
+    const std::string& valueName, std::vector<Table1D>& rows)
+{
+    // A single row of values is shared by every cdf row
+    unsigned int nRows, nCols, valueRows, valueCols;
+    const double* cdf = file.Get(cdfName, nRows, nCols);
+    const double* value = file.Get(valueName, valueRows, valueCols);
+    unsigned int valueStride = valueRows == 1 ? 0 : nCols;
+    rows.resize(nRows);
+    for (unsigned int i = 0; i < nRows; i++)
+    {
+        rows[i] = Table1D(cdf + i * nCols, value + i * valueStride, nCols);
+    }
+}
+
+void QEDTables::ReadText(const std::string& path, TableFile& tables)
+{
+    std::ifstream hFile, phEnFile, chiMinFile;
+    OpenTable(hFile, path, "hsokolov.table", "h");
+    OpenTable(phEnFile, path, "ksi_sokolov.table", "photon energy sampling");
+    OpenTable(chiMinFile, path, "chimin.table", "chimin energy sampling");
+
+    std::ifstream tFile, fractFile, epsilonFile, chiFile;
+    OpenTable(tFile, path, "pairprod.table", "T");
+    OpenTable(fractFile, path, "e_split.table", "pair energy split");
+    OpenTable(epsilonFile, path, "epsilon.table", "epsilon split");
+    OpenTable(chiFile, path, "log_chi.table", "log chi");
+
+    // h table
+    unsigned int hLength;
+    hFile >> hLength;
+    std::vector<double> hEtaAxis(hLength), hData(hLength);
+    for (unsigned int i = 0; i < hLength; i++)
+    {
+        hFile >> hEtaAxis[i] >> hData[i];
+    }
+    tables.Add("h.log_eta", 1, hLength, hEtaAxis);
+    tables.Add("h.log_h", 1, hLength, hData);
+
+    // photon energy and chi min tables, the chi axis of each row runs from
+    // chi min to half of eta
+    unsigned int etaLength, chiLength;
+    double logMaxEta, logMinEta;
+    phEnFile >> etaLength >> chiLength >> logMinEta >> logMaxEta;
+    std::vector<double> etaRange(2);
+    etaRange[0] = logMinEta;
+    etaRange[1] = logMaxEta;
+    tables.Add("photon_energy.log_eta_range", 1, 2, etaRange);
+
+    double deltaEta = (logMaxEta - logMinEta) / (etaLength - 1.0);
+    std::vector<double> cdf(etaLength * chiLength), chi(etaLength * chiLength);
+    for (unsigned int i = 0; i < etaLength; i++)
+    {
+        double chiMin;
+        chiMinFile >> chiMin;
+        double logMinChi = std::log10(chiMin);
+        double deltaChi = (logMinEta + i * deltaEta - std::log10(2.0)
+            - logMinChi)  / (etaLength - 1.0);
+        for (unsigned int j = 0; j < chiLength; j++)
+        {
+            chi[i * chiLength + j] = logMinChi + j * deltaChi;
+            phEnFile >> cdf[i * chiLength + j];
+        }
+    }
+    tables.Add("photon_energy.cdf", etaLength, chiLength, cdf);
+    tables.Add("photon_energy.log_chi", etaLength, chiLength, chi);
+
+    // T table
+    unsigned int tLength;
+    tFile >> tLength;
+    std::vector<double> tChiAxis(tLength), tData(tLength);
+    for (unsigned int i = 0; i < tLength; i++)
+    {
+        tFile >> tChiAxis[i] >> tData[i];
+    }
+    tables.Add("pair.log_chi", 1, tLength, tChiAxis);
+    tables.Add("pair.log_t", 1, tLength, tData);
+
+    // pair energy split table
+    unsigned int fractLength;
+    fractFile >> fractLength;
+    std::vector<double> chiAxis(fractLength), fractAxis(fractLength);
+    for (unsigned int i = 0; i < fractLength; i++)
+    {
+        chiFile >> chiAxis[i];
+        epsilonFile >> fractAxis[i];
+    }
+    tables.Add("pair_split.log_chi", 1, fractLength, chiAxis);
+    tables.Add("pair_split.fraction", 1, fractLength, fractAxis);
+
+    std::vector<double> fractCdf(fractLength * fractLength);
+    for (unsigned int i = 0; i < fractCdf.size(); i++)
+    {
+        fractFile >> fractCdf[i];
+    }
+    tables.Add("pair_split.cdf", fractLength, fractLength, fractCdf);
+}
@@ -0,0 +1,71 @@
+#ifndef QEDTABLES_HH
+#define QEDTABLES_HH
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TableFile.hh"
+#include "LookupTable.hh"
+
+/* Access to the QED data tables. The tables are read from the directory given
+   by QED_TABLES_PATH, from the binary file made by QEDTABLES if there is one
+   and otherwise from the original text tables. Either way the processes see
+   the same named arrays, 1D arrays are stored as a single row:
+    h.log_eta, h.log_h                      h factor
+    photon_energy.log_eta_range             first and last eta of the rows
+    photon_energy.cdf, photon_energy.log_chi    one row per eta
+    pair.log_chi, pair.log_t                T factor
+    pair_split.log_chi, pair_split.fraction     axes of the split table
+    pair_split.cdf                          one row per chi
+   The tables are immutable so every process object and thread shares one
+   copy through a registry. The registry only holds weak references, so the
+   tables are freed once the last process using them is destroyed. */
+namespace QEDTables
+{
+    const std::string binaryName = "qed_tables.bin";
+
+    // Grids of the inverted sampling tables, see SamplingTable
+    const unsigned int samplingPoints = 1025;
+    const unsigned int samplingTailPoints = 257;
+    const double samplingTailProb = 1.0 / 64.0;
+
+    // Tables used by the photon emission processes
+    struct EmissionTables
+    {
+        // h factor, log10(h) against log10(eta)
+        Table1D h;
+        // Inverse distribution of log10(chi) for each log10(eta)
+        SamplingTable photonEnergy;
+    };
+
+    // Tables used by the pair production processes
+    struct PairTables
+    {
+        // T factor, log10(T) against log10(chi)
+        Table1D t;
+        // Inverse distribution of the positron energy fraction for each
+        // log10(chi)
+        SamplingTable split;
+    };
+
+    // Directory holding the tables, exits if QED_TABLES_PATH is not set
+    std::string TablePath();
+
+    // Shared arrays, loaded on first use
+    std::shared_ptr<const TableFile> Load();
+
+    // Shared lookup tables built from the arrays
+    std::shared_ptr<const EmissionTables> Emission();
+
+    std::shared_ptr<const PairTables> PairProduction();
+
+    // Tables of the sampled value against the cumulative probability, one per
+    // row of the named arrays. These are what the sampling tables invert
+    void CDFRows(const TableFile& file, const std::string& cdfName,
+        const std::string& valueName, std::vector<Table1D>& rows);
+
+    // Reads the text tables in path, exits if any are missing
+    void ReadText(const std::string& path, TableFile& tables);
+}
+#endif
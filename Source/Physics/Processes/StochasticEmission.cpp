@@ -1,6 +1,4 @@
 #include "StochasticEmission.hh"
-#include <Numerics.hh>
-#include "Photon.hh"
 #include <MCTools.hh>
 
 StochasticEmission::StochasticEmission(EMField* field, double dt,
@@ -13,41 +11,44 @@ StochasticEmission::~StochasticEmission()
 {
 }
 
-void StochasticEmission::Interact(Particle *part, ParticleList *partList) const
+void StochasticEmission::Interact(ParticleList* partList, unsigned int index,
+    double dt) const
 {
-    if (part->GetMass() == 0 || part->IsAlive() == false) return;
-    // First we need to update the optical depth of the particle based on local values
-    double eta = CalculateEta(part);
-
-    // Check for very small values of eta and skip interpolation
-    double logh;
-    if (eta < 1.0e-12)
-    {
-        logh = 0.7193;
-    } else
-    {
-        logh = Numerics::Interpolate1D(m_h_etaAxis, m_h_dataTable,
-            m_h_length, std::log10(eta));
-    }
-    double deltaOD = m_dt * std::sqrt(3) * UnitsSystem::alpha * eta
-        * std::pow(10.0, logh)
-        / (part->GetGamma() * 2.0 * UnitsSystem::pi);
-    part->UpdateOpticalDepth(deltaOD);
-    // Now check if process hass occured. If so then emmit and react
-    if (part->GetOpticalDepth() < 0.0)
+    if (partList->GetSpecies(index) == Species::Photon
+        || partList->IsAlive(index) == false) return;
+    // The optical depth runs down at an upper bound of the rate, which only
+    // needs the field strength. Each time it runs out is a candidate, for
+    // which the rate is worked out and the emission accepted with the ratio
+    // of the rate to the bound
+    double bound = PhotonNumberBound(StrengthBound(partList, index), dt);
+    partList->UpdateOpticalDepth(index, bound);
+    if (partList->GetOpticalDepth(index) >= 0.0) return;
+    double eta = CalculateEta(partList, index);
+    double number = PhotonNumber(eta, partList->GetGamma(index), dt);
+    if (NextCandidate(partList, index, number, bound))
     {
         double chi = CalculateChi(eta);
-        double gammaE = 2.0 * chi * part->GetGamma() / eta;
-        ThreeVector gammaP = gammaE * part->GetDirection();
-        part->UpdateTrack(part->GetPosition(), part->GetMomentum() - gammaP);
+        double gammaE = 2.0 * chi * partList->GetGamma(index) / eta;
+        ThreeVector partDir = partList->GetDirection(index);
+        ThreeVector gammaP = gammaE * partDir;
+        partList->UpdateTrack(index, partList->GetPosition(index),
+            partList->GetMomentum(index) - gammaP);
         // Add new partles to the simulation
         if (gammaE > m_eMin && m_sampleFrac < MCTools::RandDouble(0, 1))
         {
-            Photon* photon = new Photon(gammaE, part->GetPosition(), 
-                part->GetDirection(), part->GetWeight() / m_sampleFrac,
-                part->GetTime(), m_track);
-            partList->AddParticle(photon);
+            partList->AddParticle(Species::Photon,
+                partList->GetPosition(index), gammaP,
+                partList->GetWeight(index) / m_sampleFrac,
+                partList->GetTime(index), m_track);
         }
-        part->InitOpticalDepth();
     }
-}
\ No newline at end of file
+}
+
+double StochasticEmission::OpticalDepthChange(ParticleList* partList,
+    unsigned int index, double dt) const
+{
+    if (partList->GetSpecies(index) == Species::Photon
+        || partList->IsAlive(index) == false) return 0;
+    return PhotonNumber(CalculateEta(partList, index), partList->GetGamma(index),
+        dt);
+}
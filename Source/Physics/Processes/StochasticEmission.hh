@@ -11,7 +11,12 @@ public:
 
     virtual ~StochasticEmission();
 
-    void Interact(Particle *part, ParticleList *partList) const override;
-    
+    using Process::Interact;
+
+    void Interact(ParticleList* partList, unsigned int index,
+        double dt) const override;
+
+    double OpticalDepthChange(ParticleList* partList, unsigned int index,
+        double dt) const override;
 };
 #endif
\ No newline at end of file
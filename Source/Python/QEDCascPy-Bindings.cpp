@@ -10,9 +10,13 @@ PYBIND11_MODULE(QEDCascPy, module)
     py::class_<RunManager>(module, "RunManager")
         .def(py::init<>())
         .def("setTime", &RunManager::setTime, "Set the end time and time-step")
+        .def("setAdaptiveStep", &RunManager::setAdaptiveStep,
+            "Let each lepton choose its own time-step", py::arg("minTimeStep"),
+            py::arg("gyroFraction") = 0.05, py::arg("maxOpticalDepth") = 0.1)
         .def("setField", &RunManager::setField, "Set the field properties")
         .def("setGenerator", &RunManager::setGenerator, "Set the particle source")
         .def("setPhysics", &RunManager::setPhysics, "Select physics model")
+        .def("setPusher", &RunManager::setPusher, "Select particle pusher")
         .def("setSampleFraction", &RunManager::setSampleFraction,
             "Set sampling fraction for continuos radiation")
         .def("usePairProduction", &RunManager::usePairProduction,
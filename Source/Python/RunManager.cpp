@@ -1,23 +1,25 @@
+#include <algorithm>
+#include <cmath>
+
 #include "RunManager.hh"
+#include "AdaptiveStepper.hh"
+#include "StepTasks.hh"
 
 #include "GaussianEMField.hh"
 #include "FocusingField.hh"
 #include "ContinuousEmission.hh"
 #include "StochasticEmission.hh"
 #include "NonLinearBreitWheeler.hh"
-#include "LorentzPusher.hh"
-#include "LandauPusher.hh"
-#include "ModifiedLandauPusher.hh"
+#include "PhotonDecay.hh"
+#include "MCTools.hh"
+#include "TaskScheduler.hh"
 #include <pybind11/stl.h>
 
-#ifdef USEOPENMP
-    #include <omp.h>
-#endif
-
 RunManager::RunManager():
-m_timeStep(0), m_timeEnd(0), m_field(nullptr), m_pusher(nullptr), 
+m_timeStep(0), m_timeEnd(0), m_minTimeStep(0), m_gyroFraction(0.05),
+m_maxOpticalDepth(0.1), m_field(nullptr), m_pusher(nullptr), 
 m_generator(nullptr), m_fieldSet(false), m_physSet(false), m_genSet(false),
-m_sampleFrac(1), m_useBW(false)
+m_pusherType("RK4"), m_sampleFrac(1), m_useBW(false)
 {
     // Update this if I ever add another unit system
     m_units = new UnitsSystem("SI");
@@ -38,6 +40,14 @@ void RunManager::setTime(double timeStep, double timeEnd)
     m_timeEnd = timeEnd / m_units->RefTime();
 }
 
+void RunManager::setAdaptiveStep(double minTimeStep, double gyroFraction,
+    double maxOpticalDepth)
+{
+    m_minTimeStep = minTimeStep / m_units->RefTime();
+    m_gyroFraction = gyroFraction;
+    m_maxOpticalDepth = maxOpticalDepth;
+}
+
 void RunManager::setField(const std::string& fieldType, double maxField, 
     double wavelength, double duration, double waist, double polarisation,
     const ThreeVector& start, const ThreeVector& focus)
@@ -80,6 +90,11 @@ void RunManager::setPhysics(const std::string& physics)
     }
 }
 
+void RunManager::setPusher(const std::string& pusher)
+{
+    m_pusherType = pusher;
+}
+
 void RunManager::setGenerator(const std::string& particleType,
     const std::string& energyDist, double energyParam1, double energyParam2,
     double radius, double duration, double divergence, 
@@ -156,192 +171,235 @@ void RunManager::beamOn(int events, int threads)
     }
     
     // Set the physics
+    RadiationReaction radReaction;
     if (m_physics == "Classical" || m_physics == "classical")
     {
-        m_pusher = new LandauPusher(m_field, m_timeStep);
+        radReaction = RadiationReaction::Landau;
         ContinuousEmission* emission = new ContinuousEmission(m_field,
             m_timeStep, true, m_sampleFrac, false, 0);
         m_processList.push_back(emission);
     } else if (m_physics == "Semiclassical" || m_physics == "semiclassical")
     {
-        m_pusher = new ModifiedLandauPusher(m_field, m_timeStep);
+        radReaction = RadiationReaction::ModifiedLandau;
         ContinuousEmission* emission = new ContinuousEmission(m_field,
             m_timeStep, false, m_sampleFrac, false, 0);
         m_processList.push_back(emission);
     } else
     {
-        m_pusher = new LorentzPusher(m_field, m_timeStep);
+        radReaction = RadiationReaction::None;
         StochasticEmission* emission = new StochasticEmission(m_field,
             m_timeStep, m_sampleFrac, false, 0);
         m_processList.push_back(emission);
     }
 
+    m_pusher = ParticlePusher::Create(m_pusherType, m_field, m_timeStep,
+        radReaction);
+    if (m_pusher == nullptr)
+    {
+        std::cerr << "Error: Unknown pusher. Choices are: \"RK4\", \"Boris\", "
+            "\"Vay\", \"HigueraCary\" or, for quantum physics in a static or "
+            "plane field, \"Exact\"." << std::endl;
+        return;
+    }
+
+    // Each photon's decay is found once along its path, see PhotonDecay
+    NonLinearBreitWheeler* breitWheeler = nullptr;
     if (m_useBW == true)
     {
-        NonLinearBreitWheeler* breitWheeler = new NonLinearBreitWheeler(m_field, 
-            m_timeStep, false);
-        m_processList.push_back(breitWheeler);
+        breitWheeler = new NonLinearBreitWheeler(m_field, m_timeStep, false);
     }
 
 
+    // Events are balanced over the threads by stealing and the steps of the
+    // largest are split between them, see TaskScheduler and StepTasks
+    TaskScheduler scheduler(threads);
+    StepTasks stepTasks(&scheduler);
+
+    AdaptiveStepper* stepper = nullptr;
+    if (m_minTimeStep > 0)
+    {
+        stepper = new AdaptiveStepper(m_pusher, m_processList, m_minTimeStep,
+            m_gyroFraction, m_maxOpticalDepth, &stepTasks);
+    }
+
     // set the generator
     m_generator = new SourceGenerator(m_particleType, m_energyDist, events, 
         m_energyParam1, m_energyParam2, m_radius, m_particleDuration, 
         m_divergence, m_position, m_direction);
 
-    m_input_P_X = std::vector<std::vector<double>>(threads);
-    m_electron_P_X = std::vector<std::vector<double>>(threads);
-    m_positron_P_X = std::vector<std::vector<double>>(threads);
-    m_photon_P_X = std::vector<std::vector<double>>(threads);
+    m_inputShards.Resize(scheduler.GetNThreads());
+    m_electronShards.Resize(scheduler.GetNThreads());
+    m_positronShards.Resize(scheduler.GetNThreads());
+    m_photonShards.Resize(scheduler.GetNThreads());
+    m_input_P_X.clear();
+    m_electron_P_X.clear();
+    m_positron_P_X.clear();
+    m_photon_P_X.clear();
 
     long unsigned int nEvents = m_generator->GetSourceNumber();
     
-#ifdef USEOPENMP
-    omp_set_num_threads(threads);
-    #pragma omp parallel for
-#endif
-    for (unsigned int i = 0; i < nEvents; i++) //loop primes
+    scheduler.Run(nEvents, [&](unsigned long i) //loop primes
     {
-#ifdef USEOPENMP
-        int tid = omp_get_thread_num();
-#else
-        int tid = 0;
-#endif
-        ParticleList* event = m_generator->GenerateList();
+        m_inputShards.BeginEvent(i);
+        m_electronShards.BeginEvent(i);
+        m_positronShards.BeginEvent(i);
+        m_photonShards.BeginEvent(i);
+        MCTools::SetEventStream(i);
+        ParticleList* event = m_generator->GenerateList(i);
         // Store inital particle properties
         for (unsigned int j = 0; j < event->GetNPart(); j++) // Loop particles
         {
-            m_input_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[0]
+            m_inputShards.Add(event->GetMomentum(j)[0]
                 * m_units->RefMomentum());
-            m_input_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[1]
+            m_inputShards.Add(event->GetMomentum(j)[1]
                 * m_units->RefMomentum());
-            m_input_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[2]
+            m_inputShards.Add(event->GetMomentum(j)[2]
                 * m_units->RefMomentum());
-            m_input_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[0]
+            m_inputShards.Add(event->GetPosition(j)[0]
                 * m_units->RefLength());
-            m_input_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[1]
+            m_inputShards.Add(event->GetPosition(j)[1]
                 * m_units->RefLength());
-            m_input_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[2]
+            m_inputShards.Add(event->GetPosition(j)[2]
                 * m_units->RefLength());
         }
 
+        PhotonDecay* decay = breitWheeler != nullptr
+            ? new PhotonDecay(breitWheeler, m_timeEnd) : nullptr;
+
         double time(0);
         while(time < m_timeEnd) //loop time
         {
-            // Push particles and interact
-            for (unsigned int j = 0; j < event->GetNPart(); j++) // Loop particles
+            if (decay != nullptr) decay->Update(event, time);
+
+            // Away from the field the particles go straight, so they jump
+            // to where they can next meet it
+            double maxSteps = (m_timeEnd - time) / m_timeStep;
+            maxSteps = stepper != nullptr ? std::floor(maxSteps)
+                : std::ceil(maxSteps);
+            unsigned int steps = m_pusher->FreeStream(event,
+                maxSteps > 0 ? maxSteps : 0);
+            if (steps == 0 && stepper != nullptr)
+            {
+                // The last step is shortened to end exactly at the end
+                double step = std::min(m_timeStep, m_timeEnd - time);
+                stepper->Step(event, step);
+                time = step < m_timeStep ? m_timeEnd : time + step;
+                continue;
+            } else if (steps == 0)
             {
-                m_pusher->PushParticle(event->GetParticle(j));
-                for (unsigned int proc = 0; proc < m_processList.size(); proc++) // loop processes
+                // Push particles and interact, a range at a time if the
+                // event is split. Secondaries already have the time at the
+                // end of the step so wait for the next one
+                event->AdvancePhotons(m_pusher->GetTimeStep());
+                stepTasks.ForEachRange(event,
+                    [&](unsigned int begin, unsigned int end)
                 {
-                    m_processList[proc]->Interact(event->GetParticle(j), event);
-                }
+                    m_pusher->PushParticleRange(event, begin, end);
+                    for (unsigned int j = begin; j < end; j++) // Loop particles
+                    {
+                        // The processes stepped only act on leptons
+                        if (event->IsBallistic(j)) continue;
+                        for (unsigned int proc = 0; proc < m_processList.size(); proc++) // loop processes
+                        {
+                            m_processList[proc]->Interact(event, j);
+                        }
+                    }
+                });
+                steps = 1;
             }
-            time += m_timeStep;
+            for (unsigned int j = 0; j < steps; j++) time += m_timeStep;
         }
+        if (decay != nullptr) decay->Update(event, time);
+        delete decay;
         
         // Store final particle properties
         for (long unsigned int j = 0; j < event->GetNPart(); ++j)
         {
-            if (event->GetParticle(j)->GetCharge() == -1)
+            if (event->GetCharge(j) == -1)
             {
-                m_electron_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[0] 
+                m_electronShards.Add(event->GetMomentum(j)[0] 
                     * m_units->RefMomentum());
-                m_electron_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[1]
+                m_electronShards.Add(event->GetMomentum(j)[1]
                     * m_units->RefMomentum());
-                m_electron_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[2]
+                m_electronShards.Add(event->GetMomentum(j)[2]
                     * m_units->RefMomentum());
-                m_electron_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[0]
+                m_electronShards.Add(event->GetPosition(j)[0]
                     * m_units->RefLength());
-                m_electron_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[1]
+                m_electronShards.Add(event->GetPosition(j)[1]
                     * m_units->RefLength());
-                m_electron_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[2]
+                m_electronShards.Add(event->GetPosition(j)[2]
                     * m_units->RefLength());
-                m_electron_P_X[tid].push_back(event->GetParticle(j)->GetWeight());
-            } else if (event->GetParticle(j)->GetCharge() == 0)
+                m_electronShards.Add(event->GetWeight(j));
+            } else if (event->GetCharge(j) == 0)
             {
-                m_photon_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[0]
+                m_photonShards.Add(event->GetMomentum(j)[0]
                     * m_units->RefMomentum());
-                m_photon_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[1]
+                m_photonShards.Add(event->GetMomentum(j)[1]
                     * m_units->RefMomentum());
-                m_photon_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[2]
+                m_photonShards.Add(event->GetMomentum(j)[2]
                     * m_units->RefMomentum());
-                m_photon_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[0]
+                m_photonShards.Add(event->GetPosition(j)[0]
                     * m_units->RefLength());
-                m_photon_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[1]
+                m_photonShards.Add(event->GetPosition(j)[1]
                     * m_units->RefLength());
-                m_photon_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[2]
+                m_photonShards.Add(event->GetPosition(j)[2]
                     * m_units->RefLength());
-                m_photon_P_X[tid].push_back(event->GetParticle(j)->GetWeight());
-            } else if (event->GetParticle(j)->GetCharge() == 1)
+                m_photonShards.Add(event->GetWeight(j));
+            } else if (event->GetCharge(j) == 1)
             {
-                m_positron_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[0]
+                m_positronShards.Add(event->GetMomentum(j)[0]
                     * m_units->RefMomentum());
-                m_positron_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[1]
+                m_positronShards.Add(event->GetMomentum(j)[1]
                     * m_units->RefMomentum());
-                m_positron_P_X[tid].push_back(event->GetParticle(j)->GetMomentum()[2]
+                m_positronShards.Add(event->GetMomentum(j)[2]
                     * m_units->RefMomentum());
-                m_positron_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[0]
+                m_positronShards.Add(event->GetPosition(j)[0]
                     * m_units->RefLength());
-                m_positron_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[1]
+                m_positronShards.Add(event->GetPosition(j)[1]
                     * m_units->RefLength());
-                m_positron_P_X[tid].push_back(event->GetParticle(j)->GetPosition()[2]
+                m_positronShards.Add(event->GetPosition(j)[2]
                     * m_units->RefLength());
-                m_positron_P_X[tid].push_back(event->GetParticle(j)->GetWeight());
+                m_positronShards.Add(event->GetWeight(j));
             }
         }
         m_generator->FreeSources(event);
-    }
+    });
+    m_inputShards.MoveTo(m_input_P_X);
+    m_electronShards.MoveTo(m_electron_P_X);
+    m_positronShards.MoveTo(m_positron_P_X);
+    m_photonShards.MoveTo(m_photon_P_X);
+    delete breitWheeler;
+    delete stepper;
 }
 
 py::array_t<double> RunManager::getInput()
 {
-    std::vector<double> accum;
-    for (auto& sub : m_input_P_X)
-    {
-        accum.insert(accum.end(), sub.begin(), sub.end());
-    }
-    int particles = accum.size() / 6;
-    py::array_t<double> result = py::cast(accum);
+    int particles = m_input_P_X.size() / 6;
+    py::array_t<double> result = py::cast(m_input_P_X);
     result.resize({particles, 6});
     return result;
 }
 
 py::array_t<double> RunManager::getElectrons()
 {
-    std::vector<double> accum;
-    for (auto& sub : m_electron_P_X)
-    {
-        accum.insert(accum.end(), sub.begin(), sub.end());
-    }
-    int particles = accum.size() / 7;
-    py::array_t<double> result = py::cast(accum);
+    int particles = m_electron_P_X.size() / 7;
+    py::array_t<double> result = py::cast(m_electron_P_X);
     result.resize({particles, 7});
     return result;
 }
 
 py::array_t<double> RunManager::getPositrons()
 {
-    std::vector<double> accum;
-    for (auto& sub : m_positron_P_X)
-    {
-        accum.insert(accum.end(), sub.begin(), sub.end());
-    }
-    int particles = accum.size() / 7;
-    py::array_t<double> result = py::cast(accum);
+    int particles = m_positron_P_X.size() / 7;
+    py::array_t<double> result = py::cast(m_positron_P_X);
     result.resize({particles, 7});
     return result;
 }
 
 py::array_t<double> RunManager::getPhotons()
 {
-    std::vector<double> accum;
-    for (auto& sub : m_photon_P_X)
-    {
-        accum.insert(accum.end(), sub.begin(), sub.end());
-    }
-    int particles = accum.size() / 7;
-    py::array_t<double> result = py::cast(accum);
+    int particles = m_photon_P_X.size() / 7;
+    py::array_t<double> result = py::cast(m_photon_P_X);
     result.resize({particles, 7});
     return result;
 }
@@ -6,6 +6,7 @@
 #include "UnitsSystem.hh"
 #include "Process.hh"
 #include "SourceGenerator.hh"
+#include "ThreadShards.hh"
 #include <vector>
 
 #include <pybind11/pybind11.h>
@@ -22,6 +23,11 @@ public:
     // Set the time-step and end time
     void setTime(double timeStep, double timeEnd);
 
+    // Let each lepton split the time-step down to minTimeStep, see
+    // AdaptiveStepper. A minTimeStep of 0 turns it off
+    void setAdaptiveStep(double minTimeStep, double gyroFraction = 0.05,
+        double maxOpticalDepth = 0.1);
+
     // Set the field parameters
     void setField(const std::string& fieldType, double maxField,
         double wavelength, double duration, double waist, double polarisation,
@@ -37,6 +43,10 @@ public:
 
     void setPhysics(const std::string& physics);
 
+    // Select the particle pusher, "RK4" (default), "Boris", "Vay" or
+    // "HigueraCary"
+    void setPusher(const std::string& pusher);
+
     // Set the fraction of photons that are tracked for continuous emission.
     void setSampleFraction(double frac);
 
@@ -65,14 +75,23 @@ private:
     ParticlePusher* m_pusher;
     SourceGenerator* m_generator;
     std::vector<Process*> m_processList;
-    std::vector<std::vector<double>> m_input_P_X;
-    std::vector<std::vector<double>> m_electron_P_X;
-    std::vector<std::vector<double>> m_positron_P_X;
-    std::vector<std::vector<double>> m_photon_P_X;
+    // Particles of each event, stored by the thread that ran it and merged
+    // in event order once all are done
+    EventShards<double> m_inputShards;
+    EventShards<double> m_electronShards;
+    EventShards<double> m_positronShards;
+    EventShards<double> m_photonShards;
+    std::vector<double> m_input_P_X;
+    std::vector<double> m_electron_P_X;
+    std::vector<double> m_positron_P_X;
+    std::vector<double> m_photon_P_X;
     
     // Time properties
     double m_timeStep;
     double m_timeEnd;
+    double m_minTimeStep;
+    double m_gyroFraction;
+    double m_maxOpticalDepth;
 
     // Field properties
     bool m_fieldSet;
@@ -88,6 +107,7 @@ private:
     // Pusher properties
     bool m_physSet;
     std::string m_physics;
+    std::string m_pusherType;
     double m_sampleFrac;
 
     // Physics properties
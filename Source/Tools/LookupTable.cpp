@@ -0,0 +1,188 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "LookupTable.hh"
+
+TableAxis::TableAxis():
+m_points(0), m_size(0), m_uniform(false), m_min(0), m_invDelta(0)
+{
+}
+
+TableAxis::TableAxis(const double* points, unsigned int size):
+m_points(0)
+{
+	Assign(points, size);
+}
+
+TableAxis::TableAxis(double min, double max, unsigned int size):
+m_points(0)
+{
+	AssignUniform(min, max, size);
+}
+
+TableAxis::~TableAxis()
+{
+}
+
+void TableAxis::Assign(const double* points, unsigned int size)
+{
+	std::shared_ptr<std::vector<double> > copy =
+		std::make_shared<std::vector<double> >(points, points + size);
+	View(copy->data(), size, copy);
+}
+
+void TableAxis::View(const double* points, unsigned int size,
+	std::shared_ptr<const void> owner)
+{
+	m_owner = owner;
+	m_points = points;
+	m_size = size;
+	CheckUniform();
+}
+
+void TableAxis::AssignUniform(double min, double max, unsigned int size)
+{
+	std::shared_ptr<std::vector<double> > points =
+		std::make_shared<std::vector<double> >(size);
+	double delta = (max - min) / (size - 1.0);
+	for (unsigned int i = 0; i < size; i++)
+	{
+		(*points)[i] = min + i * delta;
+	}
+	m_owner = points;
+	m_points = points->data();
+	m_size = size;
+	m_min = min;
+	m_invDelta = 1.0 / delta;
+	m_uniform = true;
+}
+
+void TableAxis::CheckUniform()
+{
+	m_min = m_points[0];
+	double delta = (m_points[m_size-1] - m_points[0]) / (m_size - 1.0);
+	m_invDelta = 1.0 / delta;
+	// Uniform if every point is within rounding of its grid position
+	double tolerance = 1.0e-9 * std::fabs(m_points[m_size-1] - m_points[0]);
+	m_uniform = delta > 0;
+	for (unsigned int i = 0; i < m_size && m_uniform; i++)
+	{
+		m_uniform = std::fabs(m_points[i] - (m_min + i * delta)) <= tolerance;
+	}
+}
+
+unsigned int TableAxis::SearchInterval(double x) const
+{
+	// Finds the last point not above x, the select compiles to a cmov
+	const double* base = m_points;
+	unsigned int n = m_size;
+	while (n > 1)
+	{
+		unsigned int half = n / 2;
+		base = (base[half] <= x) ? base + half : base;
+		n -= half;
+	}
+	unsigned int index = base - m_points;
+	return index < m_size - 2 ? index : m_size - 2;
+}
+
+unsigned int TableAxis::ArrayIndex(double x) const
+{
+	unsigned int index = Interval(x);
+	return (x - m_points[index] < m_points[index+1] - x) ? index : index + 1;
+}
+
+void TableAxis::ClosestPoints(double x, unsigned int& index, double& frac) const
+{
+	if (x > m_points[m_size-2])
+	{
+		std::cerr << "Error: Tables can't handle your extreme simulation."
+			<< std::endl;
+		std::exit(-1);
+	}
+	index = Interval(x);
+	frac = (x - m_points[index]) / (m_points[index+1] - m_points[index]);
+}
+
+Table1D::Table1D():
+m_data(0)
+{
+}
+
+Table1D::Table1D(const double* axis, const double* data, unsigned int size):
+m_axis(axis, size)
+{
+	std::shared_ptr<std::vector<double> > copy =
+		std::make_shared<std::vector<double> >(data, data + size);
+	m_owner = copy;
+	m_data = copy->data();
+	InitSlopes();
+}
+
+Table1D::Table1D(const double* axis, const double* data, unsigned int size,
+	std::shared_ptr<const void> owner):
+m_owner(owner), m_data(data)
+{
+	m_axis.View(axis, size, owner);
+	InitSlopes();
+}
+
+Table1D::~Table1D()
+{
+}
+
+void Table1D::InitSlopes()
+{
+	unsigned int size = m_axis.Size();
+	m_slope.resize(size);
+	for (unsigned int i = 0; i + 1 < size; i++)
+	{
+		// Repeated points, e.g. the flat ends of a CDF, are never interpolated
+		// across but could still be extrapolated from
+		double width = m_axis[i+1] - m_axis[i];
+		m_slope[i] = width > 0 ? (m_data[i+1] - m_data[i]) / width : 0.0;
+	}
+	m_slope.back() = 0;
+}
+
+SamplingTable::SamplingTable():
+m_nBody(0), m_nTail(0), m_tailProb(0), m_bodyScale(0), m_logMin(0),
+m_tailScale(0)
+{
+}
+
+SamplingTable::SamplingTable(const TableAxis& rowAxis,
+	const std::vector<Table1D>& rows, unsigned int nBody, unsigned int nTail,
+	double tailProb):
+m_rowAxis(rowAxis), m_nBody(nBody), m_nTail(nTail), m_tailProb(tailProb)
+{
+	// The tails reach down to below the smallest probability drawn by
+	// MCTools, which is 2^-54
+	m_logMin = std::log(std::ldexp(1.0, -56));
+	double logStep = (std::log(tailProb) - m_logMin) / (nTail - 1.0);
+	m_tailScale = 1.0 / logStep;
+	double bodyStep = (1.0 - 2.0 * tailProb) / (nBody - 1.0);
+	m_bodyScale = 1.0 / bodyStep;
+
+	m_body.resize(rows.size() * nBody);
+	m_lowTail.resize(rows.size() * nTail);
+	m_highTail.resize(rows.size() * nTail);
+	for (unsigned int i = 0; i < rows.size(); i++)
+	{
+		for (unsigned int j = 0; j < nBody; j++)
+		{
+			m_body[i * nBody + j] = rows[i].Interpolate(tailProb + j * bodyStep);
+		}
+		for (unsigned int j = 0; j < nTail; j++)
+		{
+			double tail = std::exp(m_logMin + j * logStep);
+			m_lowTail[i * nTail + j] = rows[i].Interpolate(tail);
+			m_highTail[i * nTail + j] = rows[i].Interpolate(1.0 - tail);
+		}
+	}
+}
+
+SamplingTable::~SamplingTable()
+{
+}
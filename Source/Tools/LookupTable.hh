@@ -0,0 +1,186 @@
+#ifndef LOOKUPTABLE_HH
+#define LOOKUPTABLE_HH
+
+#include <cmath>
+#include <vector>
+#include <memory>
+
+/* Sample points of a data table. Uniformly spaced axes, which is most of the
+   QED tables as they are uniform in log10, are detected on construction
+   and located with a single multiply. Other axes fall back to a branch-free
+   binary search. The points are either owned by the axis or viewed in
+   memory kept alive by an owner, e.g. a mapped table file, so copies are
+   cheap. */
+class TableAxis
+{
+public:
+	TableAxis();
+
+	// Copies the points and checks whether they are uniformly spaced
+	TableAxis(const double* points, unsigned int size);
+
+	// Declares a uniform axis of size points from min to max
+	TableAxis(double min, double max, unsigned int size);
+
+	~TableAxis();
+
+	void Assign(const double* points, unsigned int size);
+
+	// Uses the points in place, owner must keep them alive
+	void View(const double* points, unsigned int size,
+		std::shared_ptr<const void> owner);
+
+	void AssignUniform(double min, double max, unsigned int size);
+
+	unsigned int Size() const {return m_size;}
+
+	bool IsUniform() const {return m_uniform;}
+
+	const double* Points() const {return m_points;}
+
+	double operator[](unsigned int index) const {return m_points[index];}
+
+	double Front() const {return m_points[0];}
+
+	double Back() const {return m_points[m_size-1];}
+
+	// Lower index of the interval used to interpolate at x. Points outside the
+	// axis use the first or last interval
+	unsigned int Interval(double x) const
+	{
+		return m_uniform ? UniformInterval(x) : SearchInterval(x);
+	}
+
+	// Index of the point closest to x
+	unsigned int ArrayIndex(double x) const;
+
+	/* Returns the interval containing x and the fractional distance across it,
+	   below the axis the fraction extrapolates. Like Numerics::ClosestPoints the
+	   last interval is reserved so exits if x lies beyond the second to last
+	   point. */
+	void ClosestPoints(double x, unsigned int& index, double& frac) const;
+
+private:
+	unsigned int UniformInterval(double x) const
+	{
+		double pos = (x - m_min) * m_invDelta;
+		if (!(pos > 0)) return 0;
+		if (pos >= m_size - 2) return m_size - 2;
+		return static_cast<unsigned int>(pos);
+	}
+
+	unsigned int SearchInterval(double x) const;
+
+	void CheckUniform();
+
+private:
+	std::shared_ptr<const void> m_owner;	// keeps the points alive
+	const double* m_points;
+	unsigned int m_size;
+	bool m_uniform;
+	double m_min;
+	double m_invDelta;
+};
+
+// One dimensional table with linear interpolation and extrapolation
+class Table1D
+{
+public:
+	Table1D();
+
+	Table1D(const double* axis, const double* data, unsigned int size);
+
+	// Uses axis and data in place, owner must keep them alive
+	Table1D(const double* axis, const double* data, unsigned int size,
+		std::shared_ptr<const void> owner);
+
+	~Table1D();
+
+	double Interpolate(double x) const
+	{
+		unsigned int i = m_axis.Interval(x);
+		return m_data[i] + (x - m_axis[i]) * m_slope[i];
+	}
+
+	const TableAxis& GetAxis() const {return m_axis;}
+
+	const double* GetData() const {return m_data;}
+
+private:
+	void InitSlopes();
+
+private:
+	TableAxis m_axis;
+	std::shared_ptr<const void> m_owner;	// keeps the data alive
+	const double* m_data;
+	std::vector<double> m_slope;	// gradient of each interval
+};
+
+/* Inverse cumulative distributions of a family of distributions, one for each
+   point of a row axis. Each row is inverted on construction onto a uniform
+   grid in the cumulative probability, so drawing a sample is an index
+   computation in each direction and a bilinear blend. The inverse is steep
+   where the distributions have long tails, so the outer tailProb at each end
+   is gridded uniformly in log(prob) and log(1 - prob) instead. */
+class SamplingTable
+{
+public:
+	SamplingTable();
+
+	// Each row maps the cumulative probability to the sampled value
+	SamplingTable(const TableAxis& rowAxis, const std::vector<Table1D>& rows,
+		unsigned int nBody, unsigned int nTail, double tailProb);
+
+	~SamplingTable();
+
+	// Value at cumulative probability prob of the distribution for x. Like
+	// TableAxis::ClosestPoints exits if x is beyond the second to last row
+	double Sample(double x, double prob) const
+	{
+		unsigned int row;
+		double rowFrac;
+		m_rowAxis.ClosestPoints(x, row, rowFrac);
+		if (prob < m_tailProb)
+		{
+			return Blend(m_lowTail, m_nTail, row, rowFrac,
+				(std::log(prob) - m_logMin) * m_tailScale);
+		} else if (prob > 1.0 - m_tailProb)
+		{
+			return Blend(m_highTail, m_nTail, row, rowFrac,
+				(std::log(1.0 - prob) - m_logMin) * m_tailScale);
+		}
+		return Blend(m_body, m_nBody, row, rowFrac,
+			(prob - m_tailProb) * m_bodyScale);
+	}
+
+	const TableAxis& GetRowAxis() const {return m_rowAxis;}
+
+private:
+	// Bilinear interpolation at grid position pos between rows row and row+1
+	double Blend(const std::vector<double>& values, unsigned int n,
+		unsigned int row, double rowFrac, double pos) const
+	{
+		if (!(pos > 0)) pos = 0;
+		unsigned int col = pos < n - 2 ? static_cast<unsigned int>(pos) : n - 2;
+		double colFrac = pos - col;
+		const double* low = &values[row * n + col];
+		const double* high = low + n;
+		double lowValue = low[0] + colFrac * (low[1] - low[0]);
+		double highValue = high[0] + colFrac * (high[1] - high[0]);
+		return lowValue + rowFrac * (highValue - lowValue);
+	}
+
+private:
+	TableAxis m_rowAxis;
+	unsigned int m_nBody;
+	unsigned int m_nTail;
+	double m_tailProb;
+	double m_bodyScale;
+	double m_logMin;
+	double m_tailScale;
+	// Row major grids of each row's inverse
+	std::vector<double> m_body;
+	std::vector<double> m_lowTail;	// uniform in log(prob)
+	std::vector<double> m_highTail;	// uniform in log(1 - prob)
+};
+#endif
@@ -1,28 +1,81 @@
 #include "MCTools.hh"
 #include <random>
 #include <iostream>
+#include <atomic>
+#include <cmath>
 
-void MCTools::SetSeed(int seed)
+namespace
 {
-    std::srand(seed);
+    // Key shared by all threads, set once at start up
+    std::atomic<unsigned int> runSeed(0);
+    std::atomic<unsigned int> runRank(0);
+    // Gives threads that never select an event stream distinct streams
+    std::atomic<unsigned int> threadCount(0);
+
+    PhiloxEngine CreateEngine()
+    {
+        PhiloxEngine engine(runSeed, runRank);
+        engine.SetStream(~0ul, threadCount++);
+        return engine;
+    }
+}
+
+PhiloxEngine& MCTools::Engine()
+{
+    thread_local PhiloxEngine engine = CreateEngine();
+    return engine;
+}
+
+void MCTools::SetSeed(unsigned int seed, unsigned int rank)
+{
+    runSeed = seed;
+    runRank = rank;
+    Engine().SetKey(seed, rank);
+    Engine().SetStream(~0ul, 0);
+}
+
+void MCTools::SetEventStream(unsigned long event, unsigned int stream)
+{
+    PhiloxEngine& engine = Engine();
+    engine.SetKey(runSeed, runRank);
+    engine.SetStream(event, stream);
+}
+
+void MCTools::SetTaskStream(std::uint64_t base, unsigned int task)
+{
+    PhiloxEngine& engine = Engine();
+    engine.SetKey(runSeed, runRank);
+    engine.SetStream(base, 0x80000000u | task);
+}
+
+PhiloxEngine MCTools::StreamEngine(unsigned long event, unsigned int stream)
+{
+    PhiloxEngine engine(runSeed, runRank);
+    engine.SetStream(event, stream);
+    return engine;
 }
 
 double MCTools::RandDouble(double low, double high)
 {
-    std::uniform_real_distribution<double> dist(low, high);
-    return dist(generator);
+    return low + (high - low) * Engine().Uniform();
 }
 
 double MCTools::RandNorm(double mean, double sig)
 {
-    std::normal_distribution<double> dist(mean, sig);
-    return dist(generator);
+    PhiloxEngine& engine = Engine();
+    double radius = std::sqrt(-2.0 * std::log(engine.Uniform()));
+    return mean + sig * radius * std::cos(2.0 * M_PI * engine.Uniform());
+}
+
+double MCTools::RandExponential(double mean)
+{
+    return -mean * std::log(Engine().Uniform());
 }
 
 unsigned int MCTools::RandPoisson(double mean)
 {
     std::poisson_distribution<unsigned int> dist(mean);
-    return dist(generator);
+    return dist(Engine());
 }
 
 unsigned int MCTools::RandDiscrete(const std::vector<double>& distro)
@@ -94,26 +147,54 @@ Eigen::VectorXd MCTools::RandSinhArcsinhNd(const Eigen::VectorXd& mean,
 
 std::vector<double> MCTools::SampleNorm(double mean, double sig, unsigned int nSamples)
 {
+    std::vector<double> samples(nSamples);
+    FillNorm(samples.data(), nSamples, mean, sig);
+    return samples;
+}
 
-    std::normal_distribution<double> normDist(mean, sig); 
+std::vector<double> MCTools::SampleUniform(double low, double high, unsigned int nSamples)
+{
     std::vector<double> samples(nSamples);
+    FillUniform(samples.data(), nSamples, low, high);
+    return samples;
+}
 
-    for (unsigned int i = 0; i < nSamples; i++)
+void MCTools::FillUniform(double* out, unsigned int n, double low, double high)
+{
+    Engine().FillUniform(out, n);
+    if (low != 0 || high != 1)
     {
-        samples[i] = normDist(generator);
+        double range = high - low;
+        #pragma omp simd
+        for (unsigned int i = 0; i < n; i++)
+        {
+            out[i] = low + range * out[i];
+        }
     }
-    return samples;
 }
 
-std::vector<double> MCTools::SampleUniform(double low, double high, unsigned int nSamples)
+void MCTools::FillNorm(double* out, unsigned int n, double mean, double sig)
 {
+    Engine().FillNorm(out, n);
+    if (mean != 0 || sig != 1)
+    {
+        #pragma omp simd
+        for (unsigned int i = 0; i < n; i++)
+        {
+            out[i] = mean + sig * out[i];
+        }
+    }
+}
 
-    std::uniform_real_distribution<double> dist(low, high); 
-    std::vector<double> samples(nSamples);
-
-    for (unsigned int i = 0; i < nSamples; i++)
+void MCTools::FillExponential(double* out, unsigned int n, double mean)
+{
+    Engine().FillExponential(out, n);
+    if (mean != 1)
     {
-        samples[i] = dist(generator);
+        #pragma omp simd
+        for (unsigned int i = 0; i < n; i++)
+        {
+            out[i] *= mean;
+        }
     }
-    return samples;
 }
@@ -2,6 +2,8 @@
 #define MCTOOLS_HH
 
 #include <random>
+#include <vector>
+#include "PhiloxEngine.hh"
 
 #ifdef USEGEANT
 #include <Eigen/Dense>
@@ -9,12 +11,36 @@
 
 namespace MCTools
 {
-    void SetSeed(int seed);
+    /* Every thread draws from its own counter-based engine so there is no
+       shared state. The engine key is (seed, rank) and each event should
+       select its own stream, which makes the random numbers of an event
+       independent of the thread it runs on and of the number of threads. */
+    void SetSeed(unsigned int seed, unsigned int rank = 0);
+
+    // Moves the calling thread to the start of the stream for this event
+    void SetEventStream(unsigned long event, unsigned int stream = 0);
+
+    /* Moves the calling thread to the stream of one task of a step split
+       between threads. The base is drawn from the stream of the event so
+       every step has its own, the task streams are kept apart from the
+       event streams by the top bit of the stream number */
+    void SetTaskStream(std::uint64_t base, unsigned int task);
+
+    // Engine of the calling thread
+    PhiloxEngine& Engine();
+
+    /* New engine keyed by the run and placed at the start of the given
+       stream. It leaves the engine of the calling thread alone, so code
+       that must give the same numbers wherever it is called from can own
+       its stream outright */
+    PhiloxEngine StreamEngine(unsigned long event, unsigned int stream);
 
     double RandDouble(double low, double high);
 
     double RandNorm(double mean, double sig);
 
+    double RandExponential(double mean);
+
     unsigned int RandPoisson(double mean);
 
     unsigned int RandDiscrete(const std::vector<double>& distro);
@@ -25,6 +51,15 @@ namespace MCTools
     std::vector<double> SampleUniform(double low, double high,
             unsigned int nSamples);
 
+    // Batch methods filling a buffer from the calling thread's engine
+    void FillUniform(double* out, unsigned int n, double low = 0,
+            double high = 1);
+
+    void FillNorm(double* out, unsigned int n, double mean = 0,
+            double sig = 1);
+
+    void FillExponential(double* out, unsigned int n, double mean = 1);
+
 #ifdef USEGEANT
     Eigen::VectorXd RandNormNd(const Eigen::VectorXd& mean,
             const Eigen::MatrixXd& covar);
@@ -32,8 +67,5 @@ namespace MCTools
     Eigen::VectorXd RandSinhArcsinhNd(const Eigen::VectorXd& mean,
         const Eigen::VectorXd& covar, const Eigen::VectorXd& skew);
 #endif
-
-    static std::random_device rd;
-    static std::mt19937 generator(rd());
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "PhiloxEngine.hh"
+#include <cmath>
+
+PhiloxEngine::PhiloxEngine(std::uint32_t seed, std::uint32_t rank)
+{
+    SetKey(seed, rank);
+}
+
+PhiloxEngine::~PhiloxEngine()
+{
+}
+
+void PhiloxEngine::SetKey(std::uint32_t seed, std::uint32_t rank)
+{
+    m_key[0] = seed;
+    m_key[1] = rank;
+    SetStream(0, 0);
+}
+
+void PhiloxEngine::SetStream(std::uint64_t event, std::uint32_t stream)
+{
+    m_counter[0] = 0;
+    m_counter[1] = stream;
+    m_counter[2] = static_cast<std::uint32_t>(event);
+    m_counter[3] = static_cast<std::uint32_t>(event >> 32);
+    m_bufferPos = 4;
+}
+
+void PhiloxEngine::Refill()
+{
+    Block(m_counter[0], m_counter[1], m_counter[2], m_counter[3],
+        m_key[0], m_key[1], m_buffer);
+    m_counter[0]++;
+    m_bufferPos = 0;
+}
+
+void PhiloxEngine::FillUniform(double* out, unsigned int n)
+{
+    // Each block gives four words, i.e. two doubles
+    unsigned int nPairs = n / 2;
+    std::uint32_t c0 = m_counter[0];
+    std::uint32_t c1 = m_counter[1];
+    std::uint32_t c2 = m_counter[2];
+    std::uint32_t c3 = m_counter[3];
+    std::uint32_t k0 = m_key[0];
+    std::uint32_t k1 = m_key[1];
+    #pragma omp simd
+    for (unsigned int i = 0; i < nPairs; i++)
+    {
+        std::uint32_t bits[4];
+        Block(c0 + i, c1, c2, c3, k0, k1, bits);
+        out[2*i]   = ToUniform(bits[0], bits[1]);
+        out[2*i+1] = ToUniform(bits[2], bits[3]);
+    }
+    if (n % 2 == 1)
+    {
+        std::uint32_t bits[4];
+        Block(c0 + nPairs, c1, c2, c3, k0, k1, bits);
+        out[n-1] = ToUniform(bits[0], bits[1]);
+    }
+    m_counter[0] += (n + 1) / 2;
+    m_bufferPos = 4;
+}
+
+void PhiloxEngine::FillNorm(double* out, unsigned int n)
+{
+    // Box-Muller on pairs of uniforms
+    FillUniform(out, n);
+    unsigned int nPairs = n / 2;
+    const double twoPi = 2.0 * M_PI;
+    #pragma omp simd
+    for (unsigned int i = 0; i < nPairs; i++)
+    {
+        double radius = std::sqrt(-2.0 * std::log(out[2*i]));
+        double angle = twoPi * out[2*i+1];
+        out[2*i]   = radius * std::cos(angle);
+        out[2*i+1] = radius * std::sin(angle);
+    }
+    if (n % 2 == 1)
+    {
+        double radius = std::sqrt(-2.0 * std::log(out[n-1]));
+        out[n-1] = radius * std::cos(twoPi * Uniform());
+    }
+}
+
+void PhiloxEngine::FillExponential(double* out, unsigned int n)
+{
+    FillUniform(out, n);
+    #pragma omp simd
+    for (unsigned int i = 0; i < n; i++)
+    {
+        out[i] = -std::log(out[i]);
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef PHILOXENGINE_HH
+#define PHILOXENGINE_HH
+
+#include <cstdint>
+
+/* Counter-based random number generator (Philox4x32-10, Salmon et al. 2011).
+   Each output block is a pure function of a 128 bit counter and a 64 bit key,
+   so there is no state to share between threads and any draw can be
+   regenerated from its coordinates alone. The key holds the run seed and
+   the MPI rank, the counter holds the draw number, a stream number and a
+   64 bit event number. The engine satisfies the standard uniform random bit
+   generator requirements so it can be used with the <random> distributions. */
+class PhiloxEngine
+{
+public:
+    typedef std::uint32_t result_type;
+
+    PhiloxEngine(std::uint32_t seed = 0, std::uint32_t rank = 0);
+
+    ~PhiloxEngine();
+
+    static constexpr result_type min() {return 0;}
+
+    static constexpr result_type max() {return 0xFFFFFFFFu;}
+
+    // Sets the key, this restarts the current stream
+    void SetKey(std::uint32_t seed, std::uint32_t rank);
+
+    // Moves to the start of the sequence for the given event and stream
+    void SetStream(std::uint64_t event, std::uint32_t stream = 0);
+
+    // Returns the next 32 random bits
+    result_type operator()()
+    {
+        if (m_bufferPos == 4) Refill();
+        return m_buffer[m_bufferPos++];
+    }
+
+    // Uniform double on the open interval (0, 1) with 53 bits of randomness
+    double Uniform()
+    {
+        std::uint32_t high = (*this)();
+        std::uint32_t low = (*this)();
+        return ToUniform(high, low);
+    }
+
+    // Batch methods, these always start from a fresh counter block and the
+    // main loops have no dependencies between iterations so they vectorise
+    void FillUniform(double* out, unsigned int n);
+
+    void FillNorm(double* out, unsigned int n);
+
+    void FillExponential(double* out, unsigned int n);
+
+    // The bijection at the heart of the generator
+    static void Block(std::uint32_t c0, std::uint32_t c1, std::uint32_t c2,
+        std::uint32_t c3, std::uint32_t k0, std::uint32_t k1,
+        std::uint32_t out[4]);
+
+    static double ToUniform(std::uint32_t high, std::uint32_t low)
+    {
+        std::uint64_t bits = (static_cast<std::uint64_t>(high >> 5) << 26)
+            | (low >> 6);
+        return (bits + 0.5) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    void Refill();
+
+private:
+    std::uint32_t m_key[2];
+    std::uint32_t m_counter[4];     // draw block, stream, event low, event high
+    std::uint32_t m_buffer[4];
+    unsigned int m_bufferPos;
+};
+
+inline void PhiloxEngine::Block(std::uint32_t c0, std::uint32_t c1,
+    std::uint32_t c2, std::uint32_t c3, std::uint32_t k0, std::uint32_t k1,
+    std::uint32_t out[4])
+{
+    for (unsigned int round = 0; round < 10; round++)
+    {
+        std::uint64_t prod0 = static_cast<std::uint64_t>(0xD2511F53u) * c0;
+        std::uint64_t prod1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c2;
+        std::uint32_t n0 = static_cast<std::uint32_t>(prod1 >> 32) ^ c1 ^ k0;
+        std::uint32_t n2 = static_cast<std::uint32_t>(prod0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<std::uint32_t>(prod1);
+        c3 = static_cast<std::uint32_t>(prod0);
+        c0 = n0;
+        c2 = n2;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+#endif
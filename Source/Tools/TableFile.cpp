@@ -0,0 +1,235 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TableFile.hh"
+
+namespace
+{
+	const char magic[8] = {'Q', 'E', 'D', 'T', 'A', 'B', 'L', 'E'};
+	const std::uint32_t byteOrder = 0x01020304;
+	const std::size_t alignment = 64;
+
+	struct FileHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t byteOrder;
+		std::uint32_t nEntries;
+		std::uint32_t reserved;
+		std::uint64_t fileSize;
+		std::uint64_t checksum;	// of everything after the header
+		char padding[24];
+	};
+
+	struct FileEntry
+	{
+		char name[40];
+		std::uint32_t rows;
+		std::uint32_t cols;
+		std::uint64_t offset;	// in bytes from the start of the file
+		std::uint64_t count;
+	};
+
+	static_assert(sizeof(FileHeader) == 64, "Table file header must be 64 bytes");
+	static_assert(sizeof(FileEntry) == 64, "Table file entry must be 64 bytes");
+
+	// FNV-1a, cheap and plenty to catch truncated or corrupted files
+	std::uint64_t Checksum(const unsigned char* data, std::size_t size)
+	{
+		std::uint64_t hash = 14695981039346656037ull;
+		for (std::size_t i = 0; i < size; i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	std::size_t Align(std::size_t offset)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+}
+
+TableFile::TableFile():
+m_map(0), m_mapSize(0)
+{
+}
+
+TableFile::~TableFile()
+{
+	Unmap();
+}
+
+void TableFile::Unmap()
+{
+	if (m_map != 0) munmap(m_map, m_mapSize);
+	m_map = 0;
+	m_mapSize = 0;
+}
+
+bool TableFile::Open(const std::string& fileName)
+{
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(FileHeader))
+	{
+		std::cerr << "Error: Table file " << fileName << " is truncated."
+			<< std::endl;
+		close(fd);
+		return false;
+	}
+	std::size_t size = info.st_size;
+	void* map = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		std::cerr << "Error: Failed to map table file " << fileName << "."
+			<< std::endl;
+		return false;
+	}
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(map);
+	const FileHeader* header = reinterpret_cast<const FileHeader*>(bytes);
+	std::string reason;
+	if (std::memcmp(header->magic, magic, sizeof(magic)) != 0)
+	{
+		reason = "is not a table file";
+	} else if (header->byteOrder != byteOrder)
+	{
+		reason = "was written with a different byte order";
+	} else if (header->version != version)
+	{
+		reason = "has an unsupported version";
+	} else if (header->fileSize != size || size < sizeof(FileHeader)
+		+ header->nEntries * sizeof(FileEntry))
+	{
+		reason = "is truncated";
+	} else if (header->checksum != Checksum(bytes + sizeof(FileHeader),
+		size - sizeof(FileHeader)))
+	{
+		reason = "failed its checksum";
+	}
+
+	std::vector<Entry> entries(reason.empty() ? header->nEntries : 0);
+	const FileEntry* fileEntries = reinterpret_cast<const FileEntry*>(bytes
+		+ sizeof(FileHeader));
+	for (unsigned int i = 0; i < entries.size() && reason.empty(); i++)
+	{
+		const FileEntry& record = fileEntries[i];
+		if (record.count != (std::uint64_t)record.rows * record.cols
+			|| record.offset % alignment != 0
+			|| record.offset + record.count * sizeof(double) > size)
+		{
+			reason = "has a corrupt entry";
+		}
+		entries[i].name.assign(record.name, strnlen(record.name,
+			sizeof(record.name)));
+		entries[i].rows = record.rows;
+		entries[i].cols = record.cols;
+		entries[i].data = reinterpret_cast<const double*>(bytes + record.offset);
+	}
+
+	if (!reason.empty())
+	{
+		std::cerr << "Error: Table file " << fileName << " " << reason << "."
+			<< std::endl;
+		munmap(map, size);
+		return false;
+	}
+
+	Unmap();
+	m_owned.clear();
+	m_entries.swap(entries);
+	m_map = map;
+	m_mapSize = size;
+	return true;
+}
+
+void TableFile::Add(const std::string& name, unsigned int rows,
+	unsigned int cols, const std::vector<double>& data)
+{
+	if (name.size() >= sizeof(FileEntry().name) || data.size() != rows * cols)
+	{
+		std::cerr << "Error: Invalid table " << name << "." << std::endl;
+		std::exit(1);
+	}
+	m_owned.push_back(data);
+	Entry entry = {name, rows, cols, m_owned.back().data()};
+	m_entries.push_back(entry);
+}
+
+bool TableFile::Has(const std::string& name) const
+{
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries[i].name == name) return true;
+	}
+	return false;
+}
+
+const double* TableFile::Get(const std::string& name, unsigned int& rows,
+	unsigned int& cols) const
+{
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries[i].name == name)
+		{
+			rows = m_entries[i].rows;
+			cols = m_entries[i].cols;
+			return m_entries[i].data;
+		}
+	}
+	std::cerr << "Error: Table " << name << " not found!" << std::endl;
+	std::exit(1);
+}
+
+bool TableFile::Write(const std::string& fileName) const
+{
+	// Lay out the file in memory so the checksum can be taken in one pass
+	std::size_t size = sizeof(FileHeader) + m_entries.size() * sizeof(FileEntry);
+	std::vector<FileEntry> records(m_entries.size());
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		std::memset(&records[i], 0, sizeof(FileEntry));
+		std::memcpy(records[i].name, m_entries[i].name.c_str(),
+			m_entries[i].name.size());
+		records[i].rows = m_entries[i].rows;
+		records[i].cols = m_entries[i].cols;
+		records[i].count = (std::uint64_t)m_entries[i].rows * m_entries[i].cols;
+		records[i].offset = Align(size);
+		size = records[i].offset + records[i].count * sizeof(double);
+	}
+
+	std::vector<unsigned char> buffer(size, 0);
+	std::memcpy(buffer.data() + sizeof(FileHeader), records.data(),
+		records.size() * sizeof(FileEntry));
+	for (unsigned int i = 0; i < m_entries.size(); i++)
+	{
+		std::memcpy(buffer.data() + records[i].offset, m_entries[i].data,
+			records[i].count * sizeof(double));
+	}
+
+	FileHeader header;
+	std::memset(&header, 0, sizeof(FileHeader));
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.byteOrder = byteOrder;
+	header.nEntries = m_entries.size();
+	header.fileSize = size;
+	header.checksum = Checksum(buffer.data() + sizeof(FileHeader),
+		size - sizeof(FileHeader));
+	std::memcpy(buffer.data(), &header, sizeof(FileHeader));
+
+	std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(buffer.data()), size);
+	return file.good();
+}
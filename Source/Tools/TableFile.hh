@@ -0,0 +1,63 @@
+#ifndef TABLEFILE_HH
+#define TABLEFILE_HH
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+
+/* Container of named two dimensional arrays of doubles, used to store the QED
+   tables in binary. The file is a 64 byte header, a 64 byte record per array
+   giving its name, shape and offset, then the arrays stored contiguously in
+   row major order and aligned to 64 bytes. The header holds a version, a
+   byte order marker and a checksum of everything after it. Files are mapped
+   read only so the data is shared between processes and never parsed.
+   Arrays can also be added in memory and written out. */
+class TableFile
+{
+public:
+	TableFile();
+
+	~TableFile();
+
+	TableFile(const TableFile&) = delete;
+
+	TableFile& operator=(const TableFile&) = delete;
+
+	// Maps and validates a file. Returns false if it is missing or invalid,
+	// printing the reason for an invalid file
+	bool Open(const std::string& fileName);
+
+	// Copies an array of rows x cols values into the container
+	void Add(const std::string& name, unsigned int rows, unsigned int cols,
+		const std::vector<double>& data);
+
+	bool Has(const std::string& name) const;
+
+	// Returns the array and its shape, exits if there is no such array
+	const double* Get(const std::string& name, unsigned int& rows,
+		unsigned int& cols) const;
+
+	bool Write(const std::string& fileName) const;
+
+	static const std::uint32_t version = 1;
+
+private:
+	struct Entry
+	{
+		std::string name;
+		unsigned int rows;
+		unsigned int cols;
+		const double* data;
+	};
+
+	void Unmap();
+
+private:
+	std::vector<Entry> m_entries;
+	std::list<std::vector<double> > m_owned;	// arrays added in memory
+	void* m_map;
+	std::size_t m_mapSize;
+};
+#endif
@@ -0,0 +1,261 @@
+#include "TaskScheduler.hh"
+
+#include <chrono>
+#include <thread>
+
+#ifdef USEOPENMP
+    #include <omp.h>
+#endif
+
+namespace
+{
+    thread_local unsigned int threadIndex = 0;
+
+    double Seconds()
+    {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+TaskScheduler::TaskScheduler(unsigned int nThreads):
+m_outstanding(0), m_completed(0), m_nIdle(0), m_wallTime(0)
+{
+#ifndef USEOPENMP
+    nThreads = 1;
+#endif
+    if (nThreads == 0) nThreads = 1;
+    for (unsigned int i = 0; i < nThreads; i++)
+    {
+        Worker* worker = new Worker();
+        worker->begin = 0;
+        worker->end = 0;
+        worker->busy = 0;
+        worker->idle = 0;
+        worker->events = 0;
+        worker->nTasks = 0;
+        worker->steals = 0;
+        m_workers.push_back(std::unique_ptr<Worker>(worker));
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+}
+
+void TaskScheduler::Run(unsigned long nEvents, const EventBody& body)
+{
+    unsigned int nThreads = m_workers.size();
+    std::vector<double> busy(nThreads);
+    for (unsigned int i = 0; i < nThreads; i++)
+    {
+        m_workers[i]->begin = nEvents * i / nThreads;
+        m_workers[i]->end = nEvents * (i + 1) / nThreads;
+        busy[i] = m_workers[i]->busy;
+    }
+    m_outstanding = nEvents;
+    m_completed = 0;
+
+    double start = Seconds();
+#ifdef USEOPENMP
+    // A thread that OpenMP does not provide leaves its range to be stolen
+    #pragma omp parallel num_threads(nThreads)
+    Work(omp_get_thread_num(), body);
+#else
+    Work(0, body);
+#endif
+    double wallTime = Seconds() - start;
+    m_wallTime += wallTime;
+    for (unsigned int i = 0; i < nThreads; i++)
+    {
+        m_workers[i]->idle += wallTime - (m_workers[i]->busy - busy[i]);
+    }
+}
+
+void TaskScheduler::Work(unsigned int thread, const EventBody& body)
+{
+    threadIndex = thread;
+    Worker& self = *m_workers[thread];
+    while (true)
+    {
+        Task task;
+        TaskGroup* group;
+        unsigned long event;
+        if (NextTask(thread, task, group))
+        {
+            double start = Seconds();
+            RunTask(thread, task, group);
+            self.busy += Seconds() - start;
+            continue;
+        }
+        if (NextEvent(thread, event))
+        {
+            double start = Seconds();
+            body(event);
+            self.busy += Seconds() - start;
+            self.events++;
+            m_completed++;
+            Finish();
+            continue;
+        }
+        if (m_outstanding == 0) break;
+
+        // Everything left is running, sleep until a task is spawned
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        m_nIdle++;
+        m_wake.wait_for(lock, std::chrono::milliseconds(1));
+        m_nIdle--;
+    }
+    threadIndex = 0;
+}
+
+bool TaskScheduler::NextEvent(unsigned int thread, unsigned long& event)
+{
+    Worker& self = *m_workers[thread];
+    {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (self.begin < self.end)
+        {
+            event = self.begin++;
+            return true;
+        }
+    }
+
+    // Steal the back half of the largest range left. Only one lock is held
+    // at a time, so the range is checked again once it is locked
+    while (true)
+    {
+        unsigned int victim = thread;
+        unsigned long most = 0;
+        for (unsigned int i = 0; i < m_workers.size(); i++)
+        {
+            if (i == thread) continue;
+            std::lock_guard<std::mutex> lock(m_workers[i]->mutex);
+            if (m_workers[i]->end - m_workers[i]->begin > most)
+            {
+                most = m_workers[i]->end - m_workers[i]->begin;
+                victim = i;
+            }
+        }
+        if (most == 0) return false;
+
+        unsigned long begin, end;
+        {
+            std::lock_guard<std::mutex> lock(m_workers[victim]->mutex);
+            Worker& other = *m_workers[victim];
+            if (other.begin == other.end) continue;
+            end = other.end;
+            begin = end - (end - other.begin + 1) / 2;
+            other.end = begin;
+        }
+        std::lock_guard<std::mutex> lock(self.mutex);
+        event = begin;
+        self.begin = begin + 1;
+        self.end = end;
+        self.steals++;
+        return true;
+    }
+}
+
+bool TaskScheduler::NextTask(unsigned int thread, Task& task,
+    TaskGroup*& group)
+{
+    Worker& self = *m_workers[thread];
+    {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (!self.tasks.empty())
+        {
+            task = self.tasks.back().first;
+            group = self.tasks.back().second;
+            self.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (unsigned int i = 1; i < m_workers.size(); i++)
+    {
+        Worker& other = *m_workers[(thread + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (!other.tasks.empty())
+        {
+            task = other.tasks.front().first;
+            group = other.tasks.front().second;
+            other.tasks.pop_front();
+            self.steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::RunTask(unsigned int thread, const Task& task,
+    TaskGroup* group)
+{
+    task();
+    m_workers[thread]->nTasks++;
+    group->m_pending--;
+    Finish();
+}
+
+void TaskScheduler::Finish()
+{
+    if (--m_outstanding == 0)
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_wake.notify_all();
+    }
+}
+
+void TaskScheduler::Spawn(TaskGroup& group, const Task& task)
+{
+    group.m_pending++;
+    m_outstanding++;
+    Worker& self = *m_workers[ThreadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(self.mutex);
+        self.tasks.push_back(std::make_pair(task, &group));
+    }
+    if (m_nIdle > 0) m_wake.notify_one();
+}
+
+void TaskScheduler::Wait(TaskGroup& group)
+{
+    // Tasks run here count towards the busy time of the event waiting
+    unsigned int thread = ThreadIndex();
+    while (!group.IsDone())
+    {
+        Task task;
+        TaskGroup* owner;
+        if (NextTask(thread, task, owner))
+        {
+            RunTask(thread, task, owner);
+        } else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+unsigned int TaskScheduler::ThreadIndex()
+{
+    return threadIndex;
+}
+
+void TaskScheduler::PrintStats(std::ostream& out) const
+{
+    double busy = 0;
+    for (unsigned int i = 0; i < m_workers.size(); i++)
+    {
+        busy += m_workers[i]->busy;
+    }
+    double load = m_wallTime > 0 ? busy / (m_wallTime * m_workers.size()) : 0;
+    out << "Scheduler: threads busy " << 100.0 * load << "% of "
+        << m_wallTime << " s\n";
+    for (unsigned int i = 0; i < m_workers.size(); i++)
+    {
+        const Worker& worker = *m_workers[i];
+        out << "  Thread " << i << ": busy " << worker.busy << " s, idle "
+            << worker.idle << " s, " << worker.events << " events, "
+            << worker.nTasks << " tasks, " << worker.steals << " steals\n";
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef TASKSCHEDULER_HH
+#define TASKSCHEDULER_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Tasks spawned together, waited on as a whole
+class TaskGroup
+{
+public:
+    TaskGroup(): m_pending(0) {}
+
+    bool IsDone() const {return m_pending == 0;}
+
+private:
+    friend class TaskScheduler;
+    std::atomic<unsigned long> m_pending;
+};
+
+/* Work-stealing scheduler for the events of a run. Each thread starts with
+   a contiguous range of events and takes them from the front one at a time.
+   A thread that runs out steals the back half of the largest range left, so
+   a few long cascades are spread over the threads that are free instead of
+   holding up the run. While an event runs it may split its work into tasks
+   with Spawn, which go on a deque of the thread. The thread takes its own
+   tasks newest first when it waits on them, and idle threads steal the
+   oldest. Threads come from OpenMP when it is built, otherwise everything
+   runs on the calling thread. Busy and idle time are kept per thread. */
+class TaskScheduler
+{
+public:
+    typedef std::function<void(unsigned long)> EventBody;
+    typedef std::function<void()> Task;
+
+    TaskScheduler(unsigned int nThreads = 1);
+
+    ~TaskScheduler();
+
+    unsigned int GetNThreads() const {return m_workers.size();}
+
+    // Runs body for each event in [0, nEvents) and returns when all are done
+    void Run(unsigned long nEvents, const EventBody& body);
+
+    // Queues a task of the group, it may run on any thread
+    void Spawn(TaskGroup& group, const Task& task);
+
+    // Runs the tasks of this thread, and steals those of others, until the
+    // group is done
+    void Wait(TaskGroup& group);
+
+    // Events finished by the current run
+    unsigned long GetCompleted() const {return m_completed;}
+
+    // Index of the calling thread within the run, 0 outside it
+    static unsigned int ThreadIndex();
+
+    // Busy and idle time of every thread over all runs
+    void PrintStats(std::ostream& out) const;
+
+private:
+    // State of one thread, each is allocated on its own so threads do not
+    // share cache lines
+    struct Worker
+    {
+        std::mutex mutex;               // Guards the range and the tasks
+        unsigned long begin, end;       // Events not yet started
+        std::deque<std::pair<Task, TaskGroup*> > tasks;
+
+        double busy, idle;              // Seconds over all runs
+        unsigned long events, nTasks, steals;
+    };
+
+    void Work(unsigned int thread, const EventBody& body);
+
+    // Takes the next event of the thread or steals a range, false if none
+    bool NextEvent(unsigned int thread, unsigned long& event);
+
+    // Takes a task of the thread or steals one, false if none
+    bool NextTask(unsigned int thread, Task& task, TaskGroup*& group);
+
+    void RunTask(unsigned int thread, const Task& task, TaskGroup* group);
+
+    // Marks an event or task done, waking the idle threads after the last
+    void Finish();
+
+private:
+    std::vector<std::unique_ptr<Worker> > m_workers;
+    std::atomic<unsigned long> m_outstanding;   // Events and tasks not done
+    std::atomic<unsigned long> m_completed;
+    std::atomic<unsigned int> m_nIdle;
+    std::mutex m_idleMutex;
+    std::condition_variable m_wake;             // Signalled when tasks appear
+    double m_wallTime;                          // Seconds in Run
+};
+#endif
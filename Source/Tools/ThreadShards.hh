@@ -0,0 +1,129 @@
+#ifndef THREADSHARDS_HH
+#define THREADSHARDS_HH
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "TaskScheduler.hh"
+
+/* One value per scheduler thread, so the threads running events accumulate
+   into their own copy without locks or atomics. Each value is padded onto
+   cache lines of its own. The owner combines them once the threads are
+   done, in thread order, and must not resize while threads are running. */
+template <typename T>
+class ThreadShards
+{
+public:
+    ThreadShards(unsigned int nShards = 1): m_shards(std::max(nShards, 1u)) {}
+
+    void Resize(unsigned int nShards)
+    {
+        m_shards.resize(std::max(nShards, 1u));
+    }
+
+    unsigned int GetNShards() const {return m_shards.size();}
+
+    // Value of the calling thread
+    T& Local()
+    {
+        unsigned int thread = TaskScheduler::ThreadIndex();
+        if (thread >= m_shards.size())
+        {
+            std::cerr << "Error: No shard for thread " << thread << ", only "
+                << m_shards.size() << " were set up.\n";
+            std::exit(1);
+        }
+        return m_shards[thread].value;
+    }
+
+    T& operator[](unsigned int shard) {return m_shards[shard].value;}
+
+    const T& operator[](unsigned int shard) const
+    {
+        return m_shards[shard].value;
+    }
+
+private:
+    struct Shard
+    {
+        T value;
+        char padding[64];   // keeps neighbouring shards off its cache line
+    };
+
+    std::vector<Shard> m_shards;
+};
+
+/* Records stored by events on several threads. Each thread appends to its
+   own shard and notes where every event starts, so the records can be taken
+   out in event order whichever threads ran the events. */
+template <typename T>
+class EventShards
+{
+public:
+    EventShards(unsigned int nShards = 1): m_shards(nShards) {}
+
+    void Resize(unsigned int nShards) {m_shards.Resize(nShards);}
+
+    // Starts the records of an event on the calling thread
+    void BeginEvent(unsigned long event)
+    {
+        Shard& shard = m_shards.Local();
+        shard.starts.push_back(std::make_pair(event, shard.records.size()));
+    }
+
+    // Adds a record to the last event begun on the calling thread
+    void Add(T record)
+    {
+        m_shards.Local().records.push_back(std::move(record));
+    }
+
+    // Moves the records of all events to the end of out in event order,
+    // records of one event staying in the order they were added
+    void MoveTo(std::vector<T>& out)
+    {
+        // Event, shard and first record of each event
+        std::vector<std::pair<unsigned long, std::pair<unsigned int,
+            unsigned int> > > events;
+        for (unsigned int i = 0; i < m_shards.GetNShards(); i++)
+        {
+            const Shard& shard = m_shards[i];
+            for (unsigned int j = 0; j < shard.starts.size(); j++)
+            {
+                events.push_back(std::make_pair(shard.starts[j].first,
+                    std::make_pair(i, j)));
+            }
+        }
+        std::sort(events.begin(), events.end());
+
+        for (unsigned int k = 0; k < events.size(); k++)
+        {
+            Shard& shard = m_shards[events[k].second.first];
+            unsigned int j = events[k].second.second;
+            std::size_t begin = shard.starts[j].second;
+            std::size_t end = j + 1 < shard.starts.size()
+                ? shard.starts[j + 1].second : shard.records.size();
+            for (std::size_t r = begin; r < end; r++)
+            {
+                out.push_back(std::move(shard.records[r]));
+            }
+        }
+        for (unsigned int i = 0; i < m_shards.GetNShards(); i++)
+        {
+            m_shards[i].starts.clear();
+            m_shards[i].records.clear();
+        }
+    }
+
+private:
+    struct Shard
+    {
+        std::vector<std::pair<unsigned long, std::size_t> > starts;
+        std::vector<T> records;
+    };
+
+    ThreadShards<Shard> m_shards;
+};
+#endif
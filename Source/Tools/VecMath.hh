@@ -0,0 +1,121 @@
+#ifndef VECMATH_HH
+#define VECMATH_HH
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/* Elementary functions written without branches or library calls so that
+   loops calling them vectorise under "#pragma omp simd". The instruction set
+   is whatever the compiler targets, e.g. AVX2 or AVX-512 with -march=native,
+   and the same code runs as plain scalar code otherwise. Accuracy is within a
+   few ulp of the standard library over the ranges given. */
+namespace VecMath
+{
+    // Adding and subtracting this rounds a double to the nearest integer,
+    // which is then held in the low bits of the sum
+    const double roundShift = 6755399441055744.0;  // 1.5 * 2^52
+
+    inline std::uint64_t Bits(double x)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits;
+    }
+
+    inline double FromBits(std::uint64_t bits)
+    {
+        double x;
+        std::memcpy(&x, &bits, sizeof(x));
+        return x;
+    }
+
+    // exp(x), underflows to a tiny normal number rather than zero below -708
+    inline double Exp(double x)
+    {
+        const double log2e = 1.4426950408889634;
+        const double ln2Hi = 6.93147180369123816490e-01;
+        const double ln2Lo = 1.90821492927058770002e-10;
+        x = x < -708.0 ? -708.0 : x;
+        x = x > 709.0 ? 709.0 : x;
+
+        // x = n ln2 + r with |r| <= ln2 / 2
+        double shifted = x * log2e + roundShift;
+        double n = shifted - roundShift;
+        double r = (x - n * ln2Hi) - n * ln2Lo;
+
+        // Taylor series of exp(r), the next term is below 1e-16
+        double p = 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+
+        // 2^n built directly in the exponent bits
+        std::uint64_t scale = (Bits(shifted) + 1023) << 52;
+        return p * FromBits(scale);
+    }
+
+    // sin(x) and cos(x) together, accurate for |x| < 1e6
+    inline void SinCos(double x, double& sinX, double& cosX)
+    {
+        const double twoOverPi = 6.36619772367581382433e-01;
+        const double piOver2A = 1.57079632673412561417e+00;
+        const double piOver2B = 6.07710050630396597660e-11;
+        const double piOver2C = 2.02226624871116645580e-21;
+
+        // x = k pi/2 + r with |r| <= pi/4, the low bits of k give the quadrant
+        double shifted = x * twoOverPi + roundShift;
+        std::uint64_t quadrant = Bits(shifted);
+        double k = shifted - roundShift;
+        double r = ((x - k * piOver2A) - k * piOver2B) - k * piOver2C;
+        double r2 = r * r;
+
+        // Minimax polynomials on [-pi/4, pi/4], as in fdlibm
+        double s = 1.58969099521155010221e-10;
+        s = s * r2 - 2.50507602534068634195e-08;
+        s = s * r2 + 2.75573137070700676789e-06;
+        s = s * r2 - 1.98412698298579493134e-04;
+        s = s * r2 + 8.33333333332248946124e-03;
+        s = s * r2 - 1.66666666666666324348e-01;
+        s = r + r * r2 * s;
+
+        double c = -1.13596475577881948265e-11;
+        c = c * r2 + 2.08757232129817482790e-09;
+        c = c * r2 - 2.75573143513906633035e-07;
+        c = c * r2 + 2.48015872894767294178e-05;
+        c = c * r2 - 1.38888888888741095749e-03;
+        c = c * r2 + 4.16666666666666019037e-02;
+        c = 1.0 - 0.5 * r2 + r2 * r2 * c;
+
+        // Odd quadrants swap sin and cos, then the signs follow the quadrant
+        std::uint64_t swap = 0 - (quadrant & 1);
+        std::uint64_t sBits = (Bits(s) & ~swap) | (Bits(c) & swap);
+        std::uint64_t cBits = (Bits(c) & ~swap) | (Bits(s) & swap);
+        sinX = FromBits(sBits ^ ((quadrant & 2) << 62));
+        cosX = FromBits(cBits ^ (((quadrant + 1) & 2) << 62));
+    }
+
+    inline double Sin(double x)
+    {
+        double sinX, cosX;
+        SinCos(x, sinX, cosX);
+        return sinX;
+    }
+
+    inline double Cos(double x)
+    {
+        double sinX, cosX;
+        SinCos(x, sinX, cosX);
+        return cosX;
+    }
+}
+#endif
@@ -1,7 +1,6 @@
 
 #include "NonLinearBreitWheeler.hh"
 #include "PlaneEMField.hh" 
-#include "Photon.hh"
 #include "ParticleList.hh"
 #include "ThreeVector.hh"
 
@@ -9,9 +8,9 @@ int main(int argc, char* argv[])
 {
 	PlaneEMField* field = new PlaneEMField(1, 1, 0, ThreeVector(0,0,1));
 	NonLinearBreitWheeler* test = new NonLinearBreitWheeler(field, 0.1);
-	Photon* gamma = new Photon(1000, ThreeVector(0,0,0), ThreeVector(0,0,-1));
 	ParticleList* list = new ParticleList("List");
-	test->Interact(gamma, list);
+	list->AddParticle(Species::Photon, ThreeVector(0,0,0), ThreeVector(0,0,-1000));
+	test->Interact(list, 0);
 
 	return 0;
 }
@@ -0,0 +1,233 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "GaussianEMField.hh"
+#include "FocusingField.hh"
+#include "MCTools.hh"
+#include "UnitsSystem.hh"
+
+// The laser fields as they were written before the batched kernels, used as
+// the reference for both accuracy and speed
+struct LaserParams
+{
+	double maxE, waveLength, tau, waist, polAngle;
+	ThreeVector startPos, focusPos;
+
+	// Worked out in the constructors of the original fields
+	ThreeMatrix rotation, rotationInv;
+	double waveNum, rayleigh, eps, t0;
+
+	void Init()
+	{
+		rotation = startPos.Direction(focusPos).RotateToAxis(ThreeVector(0,0,1));
+		rotationInv = rotation.Inverse();
+		waveNum = 2.0 * UnitsSystem::pi / waveLength;
+		rayleigh = waveNum * waist * waist / 2.0;
+		eps = waist / rayleigh;
+		t0 = (startPos - focusPos).Mag();
+	}
+};
+
+void ReferenceGaussian(const LaserParams& p, double time,
+	const ThreeVector &position, ThreeVector &eField, ThreeVector &bField)
+{
+	double waveNum = p.waveNum;
+	ThreeVector position_p = p.rotation * position;
+	double t0 		 = (p.startPos - p.focusPos).Mag();
+	double r2 		 = position_p[0] * position_p[0] + position_p[1] * position_p[1];
+	double rayleigh  = waveNum * p.waist * p.waist / 2.0;
+	double curvature = (position_p[2] + rayleigh * rayleigh
+										/ (position_p[2] + 1e-99));
+	double beamWaist = p.waist * std::sqrt(1.0 + position_p[2] * position_p[2]
+										   / (rayleigh * rayleigh));
+	double E0 = p.maxE * (p.waist / beamWaist)
+				* std::exp(-1.0 * r2 / (beamWaist * beamWaist))
+				* std::cos(position_p[2] * waveNum + r2 * waveNum / (2.0 * curvature))
+				* std::exp(-1.0 * (time - t0 - position_p[2])
+							* (time - t0 - position_p[2]) / (p.tau * p.tau));
+
+	eField = p.rotationInv * ThreeVector(E0 * std::cos(p.polAngle),
+		E0 * std::sin(p.polAngle), 0);
+	bField = p.rotationInv * ThreeVector(E0 * std::sin(p.polAngle),
+		E0 * std::cos(p.polAngle), 0);
+}
+
+void ReferenceFocusing(const LaserParams& p, double time,
+	const ThreeVector &position, ThreeVector &eField, ThreeVector &bField)
+{
+	double waveNum = p.waveNum, rayleigh = p.rayleigh, eps = p.eps, t0 = p.t0;
+	ThreeVector position_p = p.rotation * position;
+	double xe = position_p[0] / p.waist;
+	double ye = position_p[1] / p.waist;
+	double ze = position_p[2] / rayleigh;
+	double r2  = position_p[0] * position_p[0] + position_p[1] * position_p[1];
+	double rho2 = r2 / (p.waist *  p.waist);
+	double curvature = position_p[2] + rayleigh * rayleigh
+		/ (position_p[2] + 1e-99);
+	double phi_G = std::atan(ze);
+	double phi = waveNum * (position_p[2] - r2 / (2.0 * curvature));
+	double w = p.waist * std::sqrt(1 + ze * ze);
+	double E_0 = p.maxE * std::exp(- r2 / (w * w) - (time - t0 - position_p[2])
+			* (time - t0 - position_p[2]) / (p.tau * p.tau));
+
+	if (E_0 < 1.0e-15)
+	{
+		  eField = ThreeVector(0, 0, 0);
+		  bField = ThreeVector(0, 0, 0);
+		  return;
+	}
+
+	double S[7];
+	for (int i = 0; i < 7; ++i)
+	{
+		S[i] = std::pow(p.waist / w, i + 1) * std::sin(phi + (i + 1) * phi_G);
+	}
+	double C[5];
+	for (int i = 0; i < 5; ++i)
+	{
+		C[i] = std::pow(p.waist / w, i + 1) * std::cos(phi + (i + 1) * phi_G);
+	}
+
+	eField[0] = E_0 * (S[0] + eps * eps * (xe * xe * S[2]
+		- rho2 * rho2 * S[3] / 4.0) + eps * eps * eps * eps
+		* (S[2] / 8.0 - rho2 * S[3] / 4.0
+			- rho2 * (rho2 - 16 * xe * xe) * S[4] / 16.0
+			- rho2 * rho2 * (rho2 + 2 * xe * xe) * S[5] / 8.0
+			+ rho2 * rho2 * rho2 * rho2 * S[6] / 32.0));
+	eField[1] = E_0 * xe * ye * (eps * eps * S[2] + eps * eps * eps
+		* eps * (rho2 * S[4] - rho2 * rho2 * S[5] / 4.0));
+	eField[2] = E_0 * xe * (eps * C[1] + eps * eps * eps * (-C[2] / 2.0 +
+		rho2 * C[3] - rho2 * rho2 * C[4] / 4.0));
+	bField[0] = 0;
+	bField[1] = E_0 * (S[0] + eps * eps * (rho2 * S[2] / 2.0 - rho2 * rho2
+		* S[3] / 4.0) + eps * eps * eps * eps * (- S[2] / 8.0 + rho2
+		* S[3] / 4.0 + 5.0 * rho2 * rho2 * S[4] / 16.0 - rho2 * rho2 * rho2
+		* S[5] / 4.0 + rho2 * rho2 *rho2 * rho2 * S[6] / 32.0));
+	bField[2] = E_0 * ye * (eps * C[1] + eps * eps * eps * (C[2] / 2.0
+		+ rho2 * C[3] / 2.0 - rho2 * rho2 * C[4] / 4.0));
+	eField[0] = eField[0] * std::cos(p.polAngle)
+		- eField[1] * std::sin(p.polAngle) ;
+	eField[1] = eField[0] * std::sin(p.polAngle)
+		+ eField[1] * std::cos(p.polAngle);
+	eField = p.rotationInv * eField;
+	bField[0] = bField[0] * std::cos(p.polAngle)
+		- bField[1] * std::sin(p.polAngle) ;
+	bField[1] = bField[0] * std::sin(p.polAngle)
+		+ bField[1] * std::cos(p.polAngle);
+	bField = p.rotationInv * bField;
+}
+
+typedef void (*ReferenceField)(const LaserParams&, double, const ThreeVector&,
+	ThreeVector&, ThreeVector&);
+
+// Compares a field against its reference at random points around the focus
+// during the pulse, and times the reference, GetField and GetFields
+void Compare(const std::string& name, const EMField& field,
+	ReferenceField reference, const LaserParams& params)
+{
+	const unsigned int nBatch = 2000;
+	double span = 4.0 * params.waist;
+	double length = (params.startPos - params.focusPos).Mag();
+	std::vector<FieldBatch> batches(nBatch);
+	for (unsigned int b = 0; b < nBatch; b++)
+	{
+		FieldBatch& batch = batches[b];
+		batch.size = FieldBatch::capacity;
+		double random[4];
+		for (unsigned int i = 0; i < batch.size; i++)
+		{
+			MCTools::FillUniform(random, 4, -1, 1);
+			batch.SetPoint(i, length + params.tau * random[0],
+				ThreeVector(span * random[1], span * random[2],
+					2.0 * span * random[3]));
+		}
+	}
+
+	std::vector<ThreeVector> refE(nBatch * FieldBatch::capacity);
+	std::vector<ThreeVector> refB(refE.size()), newE(refE.size()),
+		newB(refE.size());
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int b = 0; b < nBatch; b++)
+	{
+		for (unsigned int i = 0; i < batches[b].size; i++)
+		{
+			unsigned int j = b * FieldBatch::capacity + i;
+			reference(params, batches[b].time[i], ThreeVector(batches[b].xPos[i],
+				batches[b].yPos[i], batches[b].zPos[i]), refE[j], refB[j]);
+		}
+	}
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+	for (unsigned int b = 0; b < nBatch; b++)
+	{
+		for (unsigned int i = 0; i < batches[b].size; i++)
+		{
+			unsigned int j = b * FieldBatch::capacity + i;
+			field.GetField(batches[b].time[i], ThreeVector(batches[b].xPos[i],
+				batches[b].yPos[i], batches[b].zPos[i]), newE[j], newB[j]);
+		}
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	for (unsigned int b = 0; b < nBatch; b++)
+	{
+		field.GetFields(batches[b]);
+	}
+	std::chrono::steady_clock::time_point endBatch = std::chrono::steady_clock::now();
+
+	double maxField = 0, maxError = 0, maxBatchError = 0;
+	for (unsigned int b = 0; b < nBatch; b++)
+	{
+		for (unsigned int i = 0; i < batches[b].size; i++)
+		{
+			unsigned int j = b * FieldBatch::capacity + i;
+			ThreeVector batchE, batchB;
+			batches[b].GetField(i, batchE, batchB);
+			maxField = std::fmax(maxField, std::fmax(refE[j].Mag(), refB[j].Mag()));
+			maxError = std::fmax(maxError, std::fmax((newE[j] - refE[j]).Mag(),
+				(newB[j] - refB[j]).Mag()));
+			maxBatchError = std::fmax(maxBatchError, std::fmax(
+				(batchE - newE[j]).Mag(), (batchB - newB[j]).Mag()));
+		}
+	}
+
+	std::cout << name << ":\n";
+	std::cout << "  max |error| / max |field| = " << maxError / maxField
+		<< ", GetFields against GetField = " << maxBatchError / maxField << "\n";
+	std::cout << "  time reference = "
+		<< std::chrono::duration<double>(mid - start).count() << "s, GetField = "
+		<< std::chrono::duration<double>(end - mid).count() << "s, GetFields = "
+		<< std::chrono::duration<double>(endBatch - end).count() << "s\n";
+}
+
+int main(int argc, char* argv[])
+{
+	UnitsSystem units("SI");
+	LaserParams params;
+	params.maxE = 5.0e13 / units.RefEField();
+	params.waveLength = 0.8e-6 / units.RefLength();
+	params.tau = 10e-15 / units.RefTime();
+	params.waist = 2e-6 / units.RefLength();
+	params.polAngle = 0.3;
+	params.focusPos = ThreeVector(0, 0, 0);
+
+	// On the z axis, where the rotations are skipped, and at an angle
+	ThreeVector starts[2] = {ThreeVector(0, 0, -20e-6 / units.RefLength()),
+		ThreeVector(5e-6 / units.RefLength(), 0, -20e-6 / units.RefLength())};
+	std::string labels[2] = {"along z", "at an angle"};
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		params.startPos = starts[i];
+		params.Init();
+		GaussianEMField gaussian(params.maxE, params.waveLength, params.tau,
+			params.waist, params.polAngle, params.startPos, params.focusPos);
+		FocusingField focusing(params.maxE, params.waveLength, params.tau,
+			params.waist, params.polAngle, params.startPos, params.focusPos);
+		Compare("Gaussian field " + labels[i], gaussian, ReferenceGaussian,
+			params);
+		Compare("Focusing field " + labels[i], focusing, ReferenceFocusing,
+			params);
+	}
+	return 0;
+}
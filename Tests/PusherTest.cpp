@@ -1,4 +1,3 @@
-#include "Particle.hh"
 #include "ThreeVector.hh"
 #include "ParticlePusher.hh"
 #include "ThreeMatrix.hh"
@@ -27,15 +26,15 @@ int main(int argc, char* argv[])
 	ThreeVector x = ThreeVector(0,0,0);
 	ThreeVector p = ThreeVector(0.1,0.1,0.1);
 
-	Particle part = Particle(1.0, 1.0, 0, true);
-	part.UpdateTrack(x,p);
+	ParticleList* part = new ParticleList("Electron");
+	part->AddParticle(Species::Positron, x, p, 1, 0, true);
 
 	for(int i = 0; i < 10000; i++)
 	{
-		pusher->PushParticle(part);
+		pusher->PushParticle(part, 0);
 	}
 	
-	outManager->SingleParticle(part, "Electron");
+	outManager->SingleParticle(part, 0, "Electron");
 
 	*/	
 	return 0;
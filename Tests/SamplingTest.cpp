@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "QEDTables.hh"
+#include "LookupTable.hh"
+#include "MCTools.hh"
+
+// Compares the inverted sampling tables against interpolating the cdf rows
+// directly, which is how the samples were drawn before the tables existed
+void Compare(const std::string& name, const TableAxis& axis,
+	const std::vector<Table1D>& rows, const SamplingTable& table)
+{
+	const unsigned int nSample = 1000000;
+	std::vector<double> x(nSample), prob(nSample);
+	MCTools::FillUniform(prob.data(), nSample);
+	MCTools::FillUniform(x.data(), nSample);
+	for (unsigned int i = 0; i < nSample; i++)
+	{
+		x[i] = axis.Front() + x[i] * (axis[axis.Size()-2] - axis.Front());
+	}
+
+	std::vector<double> direct(nSample), inverted(nSample);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < nSample; i++)
+	{
+		unsigned int index;
+		double frac;
+		axis.ClosestPoints(x[i], index, frac);
+		direct[i] = (1.0 - frac) * rows[index].Interpolate(prob[i])
+			+ frac * rows[index+1].Interpolate(prob[i]);
+	}
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < nSample; i++)
+	{
+		inverted[i] = table.Sample(x[i], prob[i]);
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double maxError = 0, meanError = 0, meanDirect = 0, meanInverted = 0;
+	for (unsigned int i = 0; i < nSample; i++)
+	{
+		double error = std::fabs(inverted[i] - direct[i]);
+		maxError = error > maxError ? error : maxError;
+		meanError += error / nSample;
+		meanDirect += direct[i] / nSample;
+		meanInverted += inverted[i] / nSample;
+	}
+
+	std::cout << name << ":\n";
+	std::cout << "  max |error| = " << maxError << ", mean |error| = "
+		<< meanError << "\n";
+	std::cout << "  mean sample direct = " << meanDirect << ", inverted = "
+		<< meanInverted << "\n";
+	std::cout << "  time direct = "
+		<< std::chrono::duration<double>(mid - start).count() << "s, inverted = "
+		<< std::chrono::duration<double>(end - mid).count() << "s\n";
+}
+
+int main(int argc, char* argv[])
+{
+	std::shared_ptr<const TableFile> file = QEDTables::Load();
+	unsigned int rows, cols;
+
+	std::vector<Table1D> phEnRows;
+	QEDTables::CDFRows(*file, "photon_energy.cdf", "photon_energy.log_chi",
+		phEnRows);
+	const double* etaRange = file->Get("photon_energy.log_eta_range", rows,
+		cols);
+	TableAxis etaAxis(etaRange[0], etaRange[1], phEnRows.size());
+	Compare("Photon energy, log10(chi)", etaAxis, phEnRows,
+		QEDTables::Emission()->photonEnergy);
+
+	std::vector<Table1D> splitRows;
+	QEDTables::CDFRows(*file, "pair_split.cdf", "pair_split.fraction",
+		splitRows);
+	TableAxis chiAxis(file->Get("pair_split.log_chi", rows, cols), cols);
+	Compare("Pair energy split, fraction", chiAxis, splitRows,
+		QEDTables::PairProduction()->split);
+
+	return 0;
+}